@@ -0,0 +1,597 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MpInt.h"
+#include "MpResultCache.h"
+#include "MpThreadPool.h"
+
+// Vyraz kalkulacky: Prattuv parser sestavi strom, ktery se vyhodnoti nad MpInt<Precision>
+// Priorita od nejnizsi: + -, * / %, unarni minus, ^ (zprava), postfixovy !; volani funkci name(a, b, ...)
+// Retezce + a - (resp. *) se pri sestaveni slouci do jednoho uzlu, aby se scitanci a cinitele dali preusporadat
+// Drahe podstromy bez odkazu do historie se ukladaji do volitelne cache pod normalizovanym zapisem
+template <std::size_t Precision>
+class MpExpression final {
+public:
+    using Value = MpInt<Precision>;
+
+    // Hodnota odkazu do historie $n (index od nuly, $1 je posledni vysledek)
+    using HistoryResolver = std::function<const Value&(std::size_t)>;
+
+    using Cache = MpResultCache<Precision>;
+
+private:
+    enum class Kind { Number, History, Sum, Product, Negate, Divide, Modulo, Power, Factorial, Call };
+
+    // Uzel stromu: potomci v children, u souctu znamenka scitancu v negated
+    struct Node final {
+        Kind kind;
+        Value value;                                 // Number
+        std::size_t index = 0;                       // History
+        std::string name;                            // Call
+        std::vector<std::unique_ptr<Node>> children;
+        std::vector<bool> negated;                   // Sum
+        bool heavy = false;                          // Podstrom obsahuje drahou operaci (vyplati se paralelne)
+        bool pure = true;                            // Podstrom neodkazuje do historie (vysledek lze ulozit)
+        std::string key;                             // Normalizovany zapis (klic cache)
+
+        explicit Node(Kind kind) : kind(kind) {}
+    };
+
+    using NodePtr = std::unique_ptr<Node>;
+
+    enum class TokenType { Number, History, Name, Operator, End };
+
+    struct Token final {
+        TokenType type;
+        std::string text;
+    };
+
+    // Vazebni sily operatoru (Pratt): levy operand se vaze silou lbp, pravy se parsuje s minimem rbp
+    static constexpr int SumPower = 10;
+    static constexpr int ProductPower = 20;
+    static constexpr int UnaryPower = 30;
+    static constexpr int PowerPower = 40;
+    static constexpr int FactorialPower = 50;
+
+    NodePtr root;
+    std::vector<std::size_t> references;  // Indexy odkazu $n ve vyrazu (bez opakovani, vzestupne)
+
+    // Pomocna metoda: Rozdeleni vstupu na cisla, odkazy $n, jmena funkci a operatory
+    static std::vector<Token> tokenize(const std::string& input) {
+        std::vector<Token> tokens;
+        std::size_t i = 0;
+        while (i < input.size()) {
+            const unsigned char ch = static_cast<unsigned char>(input[i]);
+            if (std::isspace(ch)) {
+                ++i;
+                continue;
+            }
+
+            const std::size_t start = i;
+            if (std::isdigit(ch)) {
+                // Sestnactkovy literal s predponou 0x, jinak desitkovy
+                if (ch == '0' && i + 1 < input.size() && (input[i + 1] == 'x' || input[i + 1] == 'X')) {
+                    i += 2;
+                    while (i < input.size() && std::isxdigit(static_cast<unsigned char>(input[i]))) ++i;
+                }
+                else {
+                    while (i < input.size() && std::isdigit(static_cast<unsigned char>(input[i]))) ++i;
+                }
+                tokens.push_back({ TokenType::Number, input.substr(start, i - start) });
+            }
+            else if (ch == '$') {
+                ++i;
+                while (i < input.size() && std::isdigit(static_cast<unsigned char>(input[i]))) ++i;
+                if (i == start + 1) {
+                    throw std::invalid_argument("Missing history index after '$'");
+                }
+                tokens.push_back({ TokenType::History, input.substr(start + 1, i - start - 1) });
+            }
+            else if (std::isalpha(ch) || ch == '_') {
+                while (i < input.size() && (std::isalnum(static_cast<unsigned char>(input[i])) || input[i] == '_')) ++i;
+                tokens.push_back({ TokenType::Name, input.substr(start, i - start) });
+            }
+            else if (std::string("+-*/%^!(),").find(static_cast<char>(ch)) != std::string::npos) {
+                tokens.push_back({ TokenType::Operator, std::string(1, static_cast<char>(ch)) });
+                ++i;
+            }
+            else {
+                throw std::invalid_argument("Invalid character in input: " + std::string(1, static_cast<char>(ch)));
+            }
+        }
+        tokens.push_back({ TokenType::End, "" });
+        return tokens;
+    }
+
+    // Parser nad seznamem tokenu
+    class Parser final {
+    private:
+        const std::vector<Token>& tokens;
+        std::size_t position = 0;
+
+        const Token& peek() const { return tokens[position]; }
+
+        bool is_operator(const char* op) const {
+            return peek().type == TokenType::Operator && peek().text == op;
+        }
+
+        void expect(const char* op) {
+            if (!is_operator(op)) {
+                throw std::invalid_argument(std::string("Expected '") + op + "'" + describe_position());
+            }
+            ++position;
+        }
+
+        std::string describe_position() const {
+            return peek().type == TokenType::End ? " at end of input" : " before '" + peek().text + "'";
+        }
+
+        // Levy vazebni sila infixoveho nebo postfixoveho operatoru (0 = vyraz konci)
+        int left_power() const {
+            if (peek().type != TokenType::Operator) return 0;
+            switch (peek().text[0]) {
+            case '+': case '-': return SumPower;
+            case '*': case '/': case '%': return ProductPower;
+            case '^': return PowerPower;
+            case '!': return FactorialPower;
+            default: return 0;
+            }
+        }
+
+        // Prefixova cast: cislo, odkaz, volani, zavorka nebo unarni znamenko
+        NodePtr parse_prefix() {
+            const Token& token = peek();
+            if (token.type == TokenType::Number) {
+                ++position;
+                auto node = std::make_unique<Node>(Kind::Number);
+                node->value = token.text.size() > 2 && (token.text[1] == 'x' || token.text[1] == 'X')
+                    ? Value::from_hex(token.text)
+                    : Value::from_string(token.text);
+                return node;
+            }
+            if (token.type == TokenType::History) {
+                ++position;
+                const std::size_t index = token.text.size() > 9 ? 0 : std::stoul(token.text);
+                if (index == 0) {
+                    throw std::out_of_range("Invalid history index: $" + token.text);
+                }
+                auto node = std::make_unique<Node>(Kind::History);
+                node->index = index - 1;
+                return node;
+            }
+            if (token.type == TokenType::Name) {
+                ++position;
+                auto node = std::make_unique<Node>(Kind::Call);
+                node->name = token.text;
+                node->heavy = true;
+                expect("(");
+                if (!is_operator(")")) {
+                    node->children.push_back(parse(0));
+                    while (is_operator(",")) {
+                        ++position;
+                        node->children.push_back(parse(0));
+                    }
+                }
+                expect(")");
+                return node;
+            }
+            if (is_operator("(")) {
+                ++position;
+                NodePtr inner = parse(0);
+                expect(")");
+                return inner;
+            }
+            if (is_operator("-")) {
+                ++position;
+                return negate(parse(UnaryPower));
+            }
+            if (is_operator("+")) {
+                ++position;
+                return parse(UnaryPower);
+            }
+            throw std::invalid_argument("Unexpected token" + describe_position());
+        }
+
+    public:
+        explicit Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
+
+        // Vyraz, jehoz operatory se vazou alespon silou min_power
+        NodePtr parse(int min_power) {
+            NodePtr lhs = parse_prefix();
+            while (true) {
+                const int power = left_power();
+                if (power == 0 || power < min_power) break;
+
+                const char op = peek().text[0];
+                ++position;
+                if (op == '!') {
+                    lhs = make_node(Kind::Factorial, std::move(lhs));
+                    lhs->heavy = true;
+                }
+                else if (op == '^') {
+                    // Prava asociativita: 2^3^2 = 2^(3^2)
+                    lhs = make_node(Kind::Power, std::move(lhs), parse(power));
+                    lhs->heavy = true;
+                }
+                else if (op == '+' || op == '-') {
+                    lhs = make_sum(std::move(lhs), parse(power + 1), op == '-');
+                }
+                else if (op == '*') {
+                    lhs = make_product(std::move(lhs), parse(power + 1));
+                }
+                else {
+                    lhs = make_node(op == '/' ? Kind::Divide : Kind::Modulo, std::move(lhs), parse(power + 1));
+                }
+            }
+            return lhs;
+        }
+
+        // Cely vstup musi tvorit jeden vyraz
+        NodePtr parse_all() {
+            NodePtr result = parse(0);
+            if (peek().type != TokenType::End) {
+                throw std::invalid_argument("Unexpected token" + describe_position());
+            }
+            return result;
+        }
+    };
+
+    // Pomocna metoda: Uzel s potomky, drahy je, pokud je drahy nektery z potomku
+    template <typename... Children>
+    static NodePtr make_node(Kind kind, Children&&... children) {
+        auto node = std::make_unique<Node>(kind);
+        (node->children.push_back(std::forward<Children>(children)), ...);
+        for (const NodePtr& child : node->children) {
+            node->heavy = node->heavy || child->heavy;
+        }
+        return node;
+    }
+
+    // Pomocna metoda: Opacna hodnota (dvojita negace se zrusi)
+    static NodePtr negate(NodePtr operand) {
+        if (operand->kind == Kind::Negate) {
+            return std::move(operand->children.front());
+        }
+        return make_node(Kind::Negate, std::move(operand));
+    }
+
+    // Pomocna metoda: Soucet lhs +- rhs, vnorene soucty se rozvinou do jednoho seznamu scitancu
+    static NodePtr make_sum(NodePtr lhs, NodePtr rhs, bool subtract) {
+        NodePtr sum = lhs->kind == Kind::Sum ? std::move(lhs) : make_node(Kind::Sum, std::move(lhs));
+        sum->negated.resize(sum->children.size(), false);
+        sum->heavy = sum->heavy || rhs->heavy;
+        if (rhs->kind == Kind::Sum) {
+            for (std::size_t i = 0; i < rhs->children.size(); ++i) {
+                sum->children.push_back(std::move(rhs->children[i]));
+                sum->negated.push_back(rhs->negated[i] != subtract);
+            }
+        }
+        else {
+            sum->children.push_back(std::move(rhs));
+            sum->negated.push_back(subtract);
+        }
+        return sum;
+    }
+
+    // Pomocna metoda: Soucin lhs * rhs, vnorene souciny se rozvinou do jednoho seznamu cinitelu
+    // (soucin je drahy sam o sobe, i kdyz jsou cinitele literaly nebo odkazy do historie)
+    static NodePtr make_product(NodePtr lhs, NodePtr rhs) {
+        NodePtr product = lhs->kind == Kind::Product ? std::move(lhs) : make_node(Kind::Product, std::move(lhs));
+        product->heavy = true;
+        if (rhs->kind == Kind::Product) {
+            for (NodePtr& factor : rhs->children) {
+                product->children.push_back(std::move(factor));
+            }
+        }
+        else {
+            product->children.push_back(std::move(rhs));
+        }
+        return product;
+    }
+
+    // Pomocna metoda: Normalizovany zapis a cistota podstromu po sestaveni stromu. Scitanci a cinitele se radi,
+    // literaly se zapisuji desitkove bez uvodnich nul (2*a a a*2 resp. 0x10 a 16 maji stejny klic)
+    static void annotate(Node& node) {
+        std::vector<std::string> keys;
+        for (const NodePtr& child : node.children) {
+            annotate(*child);
+            node.pure = node.pure && child->pure;
+            keys.push_back(child->key);
+        }
+
+        const auto join = [&](const char* separator) {
+            std::string text;
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                if (i > 0) text += separator;
+                text += keys[i];
+            }
+            return text;
+        };
+
+        switch (node.kind) {
+        case Kind::Number:
+            node.key = node.value.to_string();
+            break;
+        case Kind::History:
+            node.pure = false;
+            node.key = "$" + std::to_string(node.index + 1);
+            break;
+        case Kind::Sum:
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                keys[i] = (node.negated[i] ? "-" : "+") + keys[i];
+            }
+            std::sort(keys.begin(), keys.end());
+            node.key = "(" + join("") + ")";
+            break;
+        case Kind::Product:
+            std::sort(keys.begin(), keys.end());
+            node.key = "(" + join("*") + ")";
+            break;
+        case Kind::Negate:
+            node.key = "(-" + keys[0] + ")";
+            break;
+        case Kind::Divide:
+            node.key = "(" + join("/") + ")";
+            break;
+        case Kind::Modulo:
+            node.key = "(" + join("%") + ")";
+            break;
+        case Kind::Power:
+            node.key = "(" + join("^") + ")";
+            break;
+        case Kind::Factorial:
+            node.key = "(" + keys[0] + "!)";
+            break;
+        case Kind::Call:
+            node.key = (node.name == "C" ? std::string("binom") : node.name) + "(" + join(",") + ")";
+            break;
+        }
+    }
+
+    // Pomocna metoda: Sber indexu odkazu do historie
+    static void collect_references(const Node& node, std::vector<std::size_t>& indices) {
+        if (node.kind == Kind::History) {
+            indices.push_back(node.index);
+        }
+        for (const NodePtr& child : node.children) {
+            collect_references(*child, indices);
+        }
+    }
+
+    // Pomocna metoda: Nezaporny argument, ktery se vejde do uint32_t
+    static uint32_t to_count(const Value& value, const char* what) {
+        if (value < Value(0) || !value.fits_in_uint32()) {
+            throw std::invalid_argument(std::string(what) + " must be a non-negative 32-bit integer");
+        }
+        return value.to_uint32();
+    }
+
+    // Pomocna metoda: Hodnoty potomku. Drahe podstromy bezi jako ulohy sdileneho poolu vlaken,
+    // na vsechny se ceka i po vyjimce (ulohy odkazuji na strom a resolver)
+    static std::vector<Value> evaluate_children(const Node& node, const HistoryResolver& history, Cache* cache) {
+        const std::size_t count = node.children.size();
+        std::vector<Value> values(count);
+
+        MpThreadPool& pool = MpThreadPool::instance();
+        const std::size_t heavy = static_cast<std::size_t>(std::count_if(node.children.begin(), node.children.end(),
+            [](const NodePtr& child) { return child->heavy; }));
+        if (pool.thread_count() < 2 || heavy < 2) {
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = evaluate(*node.children[i], history, cache);
+            }
+            return values;
+        }
+
+        // Posledni drahy podstrom pocita volajici vlakno samo
+        std::vector<std::pair<std::size_t, std::future<Value>>> tasks;
+        std::size_t submitted = 0;
+        for (std::size_t i = 0; i < count && submitted + 1 < heavy; ++i) {
+            if (node.children[i]->heavy) {
+                const Node* child = node.children[i].get();
+                tasks.emplace_back(i, pool.submit([child, &history, cache] { return evaluate(*child, history, cache); }));
+                ++submitted;
+            }
+        }
+
+        std::exception_ptr error;
+        for (std::size_t i = 0, next_task = 0; i < count; ++i) {
+            if (next_task < tasks.size() && tasks[next_task].first == i) {
+                ++next_task;
+                continue;
+            }
+            try {
+                values[i] = evaluate(*node.children[i], history, cache);
+            }
+            catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        for (auto& [index, future] : tasks) {
+            try {
+                values[index] = pool.wait(future);
+            }
+            catch (...) {
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return values;
+    }
+
+    // Pomocna metoda: Soucin cinitelu, vzdy se nasobi dva nejmensi (vyvazeny strom, male mezivysledky)
+    static Value multiply_balanced(const std::vector<Value>& factors) {
+        for (const Value& factor : factors) {
+            if (factor.is_zero()) {
+                return Value();
+            }
+        }
+
+        const auto larger = [](const Value* a, const Value* b) { return a->bit_length() > b->bit_length(); };
+        std::deque<Value> products;
+        std::priority_queue<const Value*, std::vector<const Value*>, decltype(larger)> queue(larger);
+        for (const Value& factor : factors) {
+            queue.push(&factor);
+        }
+        while (queue.size() > 1) {
+            const Value* a = queue.top();
+            queue.pop();
+            const Value* b = queue.top();
+            queue.pop();
+            products.emplace_back(*a * *b);
+            queue.push(&products.back());
+        }
+        return *queue.top();
+    }
+
+    // Pomocna metoda: Soucet scitancu od nejmensich (kratke scitance neprochazeji dlouhy mezivysledek).
+    // Omezeny typ scita v poradi zapisu, preteceni mezivysledku pak nezavisi na preusporadani
+    static Value add_ordered(std::vector<Value>& terms, const std::vector<bool>& negated) {
+        for (std::size_t i = 0; i < terms.size(); ++i) {
+            if (negated[i]) terms[i] = -terms[i];
+        }
+        if constexpr (Value::is_unlimited) {
+            std::sort(terms.begin(), terms.end(), [](const Value& a, const Value& b) { return a.bit_length() < b.bit_length(); });
+        }
+
+        Value result = std::move(terms.front());
+        for (std::size_t i = 1; i < terms.size(); ++i) {
+            result += terms[i];
+        }
+        return result;
+    }
+
+    // Pomocna metoda: Volani vestavene funkce
+    static Value call(const std::string& name, const std::vector<Value>& args) {
+        const auto expectArgs = [&](std::size_t count) {
+            if (args.size() != count) {
+                throw std::invalid_argument("Function " + name + " expects " + std::to_string(count) + " arguments");
+            }
+        };
+
+        if (name == "gcd") {
+            expectArgs(2);
+            return Value::gcd(args[0], args[1]);
+        }
+        if (name == "lcm") {
+            expectArgs(2);
+            return Value::lcm(args[0], args[1]);
+        }
+        if (name == "sqrt") {
+            expectArgs(1);
+            return Value::isqrt(args[0]);
+        }
+        if (name == "root") {
+            expectArgs(2);
+            if (args[1] < Value(1) || !args[1].fits_in_uint32()) {
+                throw std::invalid_argument("Root degree must be a positive 32-bit integer");
+            }
+            return Value::iroot(args[0], args[1].to_uint32());
+        }
+        if (name == "binom" || name == "C") {
+            expectArgs(2);
+            return Value::binomial(to_count(args[0], "Binomial argument"), to_count(args[1], "Binomial argument"));
+        }
+        if (name == "fib") {
+            expectArgs(1);
+            return Value::fibonacci(to_count(args[0], "Fibonacci index"));
+        }
+        throw std::invalid_argument("Unknown function: " + name);
+    }
+
+    // Pomocna metoda: Vyhodnoceni podstromu (cache muze byt nullptr)
+    static Value evaluate(const Node& node, const HistoryResolver& history, Cache* cache) {
+        switch (node.kind) {
+        case Kind::Number:
+            return node.value;
+        case Kind::History:
+            return history(node.index);
+        case Kind::Negate:
+            return -evaluate(*node.children.front(), history, cache);
+        case Kind::Factorial: {
+            // Faktorialy ma cache podle n (i z vyrazu s odkazy do historie)
+            const uint32_t n = to_count(evaluate(*node.children.front(), history, cache), "Factorial argument");
+            return cache != nullptr ? cache->factorial(n) : Value::factorial(n);
+        }
+        default:
+            break;
+        }
+
+        const bool cached = cache != nullptr && node.pure && node.heavy;
+        if (cached) {
+            if (const auto hit = cache->find(node.key)) {
+                return *hit;
+            }
+        }
+        Value result = evaluate_compound(node, evaluate_children(node, history, cache));
+        if (cached) {
+            cache->insert(node.key, result);
+        }
+        return result;
+    }
+
+    // Pomocna metoda: Operace slozeneho uzlu nad hodnotami potomku
+    static Value evaluate_compound(const Node& node, std::vector<Value> values) {
+        switch (node.kind) {
+        case Kind::Sum:
+            return add_ordered(values, node.negated);
+        case Kind::Product:
+            return multiply_balanced(values);
+        case Kind::Divide:
+            return values[0] / values[1];
+        case Kind::Modulo:
+            return values[0] % values[1];
+        case Kind::Power:
+            return Value::pow(values[0], to_count(values[1], "Exponent"));
+        default:
+            return call(node.name, values);
+        }
+    }
+
+    explicit MpExpression(NodePtr root) : root(std::move(root)) {
+        collect_references(*this->root, references);
+        std::sort(references.begin(), references.end());
+        references.erase(std::unique(references.begin(), references.end()), references.end());
+    }
+
+public:
+    // Rozbor vyrazu (chyby syntaxe a neplatne literaly vyhazuji std::invalid_argument)
+    static MpExpression parse(const std::string& input) {
+        const std::vector<Token> tokens = tokenize(input);
+        if (tokens.size() == 1) {
+            throw std::invalid_argument("Empty expression");
+        }
+        Parser parser(tokens);
+        NodePtr root = parser.parse_all();
+        annotate(*root);
+        return MpExpression(std::move(root));
+    }
+
+    // Odkazy $n, na kterych vysledek zavisi (index od nuly)
+    const std::vector<std::size_t>& history_references() const {
+        return references;
+    }
+
+    // Normalizovany zapis celeho vyrazu
+    const std::string& key() const {
+        return root->key;
+    }
+
+    // Vyhodnoceni, odkazy $n se ctou pres history, drahe podvysledky se hledaji a ukladaji v cache (muze byt nullptr)
+    Value evaluate(const HistoryResolver& history, Cache* cache = nullptr) const {
+        return evaluate(*root, history, cache);
+    }
+};
@@ -9,50 +9,232 @@
 #include <iomanip>
 #include <limits>
 #include <type_traits>
-#include <future>
-#include <thread>
-#include <map>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include "MpLimb.h"
+#include "MpNtt.h"
+#include "MpStorage.h"
+#include "MpThreadPool.h"
 
 template <std::size_t MaxBytes>
 class MpInt;
 
 // Vyjimka pro preteceni
+// Preteceni zjistene az na vysledku nese vysledek (pri zuzeni sirsiho mezivysledku jeho nejnizsich MaxBits bitu),
+// preteceni zjistene predem z odhadu velikosti vysledek nepocita: get_overflowed_result() je pak nula
+// a get_predicted_bits() vraci dolni odhad poctu bitu vysledku (jinak 0)
 template <std::size_t MaxBytes>
 class MpIntOverflowException final : public std::exception {  // pridano final
     std::string message;
     MpInt<MaxBytes> overflowed_result;
+    std::size_t predicted_bits = 0;
 public:
     explicit MpIntOverflowException(const std::string& msg, const MpInt<MaxBytes>& result)
         : message(msg + ": " + result.to_string()), overflowed_result(result) {
     }
+    MpIntOverflowException(const std::string& msg, std::size_t predicted_bits)
+        : message(msg + ": vysledek by mel alespon " + std::to_string(predicted_bits) + " bitu"), predicted_bits(predicted_bits) {
+    }
     const char* what() const noexcept override { return message.c_str(); }
     const MpInt<MaxBytes>& get_overflowed_result() const { return overflowed_result; }
+    std::size_t get_predicted_bits() const { return predicted_bits; }
+};
+
+// Vysledek deleni se zbytkem
+template <std::size_t MaxBytes>
+struct MpDivModResult final {
+    MpInt<MaxBytes> quotient;
+    MpInt<MaxBytes> remainder;
 };
 
+// Vysledek rozsireneho Eukleidova algoritmu: gcd = a * x + b * y
+template <std::size_t MaxBytes>
+struct MpXgcdResult final {
+    MpInt<MaxBytes> gcd;
+    MpInt<MaxBytes> x;
+    MpInt<MaxBytes> y;
+};
+
+// Chovani omezene presnosti pri preteceni v add, sub a mul: vyjimka, nasyceni na nejvetsi absolutni hodnotu,
+// nebo zachovani nejnizsich MaxBits bitu absolutni hodnoty (znamenko zustava, neomezena presnost rezim ignoruje)
+enum class MpOverflowMode { Throw, Saturate, Wrap };
+
+// Faktorialy n! pro n = 0, 64, 128, ..., FactorialTableLimit vypoctene pri prekladu (vychozi body pro mala n)
+namespace mp_detail {
+
+    inline constexpr uint32_t FactorialTableStep = 64;
+    inline constexpr uint32_t FactorialTableLimit = 1024;
+    inline constexpr std::size_t FactorialTableEntries = FactorialTableLimit / FactorialTableStep + 1;
+
+    // Pomocna metoda: Postupny vypocet faktorialu, visit dostane limby kazdeho vychoziho bodu
+    template <typename Visitor>
+    constexpr void visit_factorial_checkpoints(Visitor visit) {
+        // Kazdy cinitel ma nejvyse 11 bitu, soucin se tedy vejde do 11 * FactorialTableLimit bitu
+        std::array<limb_t, 11 * FactorialTableLimit / LimbBits + 1> value{};
+        value[0] = 1;
+        std::size_t size = 1;
+        visit(std::span<const limb_t>(value.data(), size));
+        for (uint32_t i = 1; i <= FactorialTableLimit; ++i) {
+            limb_t carry = 0;
+            for (std::size_t j = 0; j < size; ++j) {
+                value[j] = mul_add(value[j], i, 0, carry, carry);
+            }
+            if (carry != 0) {
+                value[size++] = carry;
+            }
+            if (i % FactorialTableStep == 0) {
+                visit(std::span<const limb_t>(value.data(), size));
+            }
+        }
+    }
+
+    inline constexpr std::size_t FactorialTableLimbs = [] {
+        std::size_t total = 0;
+        visit_factorial_checkpoints([&](std::span<const limb_t> limbs) { total += limbs.size(); });
+        return total;
+    }();
+
+    // Limby vsech vychozich bodu za sebou, offsets[k] je zacatek (k * FactorialTableStep)!
+    struct FactorialTable final {
+        std::array<std::size_t, FactorialTableEntries + 1> offsets{};
+        std::array<limb_t, FactorialTableLimbs> limbs{};
+    };
+
+    inline constexpr FactorialTable Factorials = [] {
+        FactorialTable table;
+        std::size_t entry = 0;
+        visit_factorial_checkpoints([&](std::span<const limb_t> limbs) {
+            std::copy(limbs.begin(), limbs.end(), table.limbs.begin() + table.offsets[entry]);
+            table.offsets[entry + 1] = table.offsets[entry] + limbs.size();
+            ++entry;
+        });
+        return table;
+    }();
+}
+
 template <std::size_t MaxBytes>
 class MpInt final {  // pridano final
 private:
-    std::vector<uint32_t> chunks;
-    bool is_negative = false;
+    template <std::size_t> friend class MpModContext;
+    template <std::size_t> friend class MpExpression;
+    template <std::size_t> friend class MpResultCache;
+    template <std::size_t> friend class MpInt;
+
+    using limb_t = mp_detail::limb_t;
+    static constexpr unsigned LimbBits = mp_detail::LimbBits;
 
     // Pomocna metoda: Zjisti zda je presnost neomezena
     static constexpr bool is_unlimited = MaxBytes == std::numeric_limits<std::size_t>::max();
 
+    // Pomocna metoda: Maximalni pocet bitu hodnoty (granularita 32bitovych slov nezavisle na sirce limbu)
+    static constexpr std::size_t MaxBits =
+        is_unlimited ? std::numeric_limits<std::size_t>::max() : (MaxBytes / sizeof(uint32_t)) * 32;
+
     // Pomocna metoda: Vypocet maximalniho poctu chunku
     static constexpr std::size_t MaxChunks =
-        is_unlimited ? std::numeric_limits<std::size_t>::max() : (MaxBytes / sizeof(uint32_t));
+        is_unlimited ? std::numeric_limits<std::size_t>::max() : (MaxBits + LimbBits - 1) / LimbBits;
+
+    // Kapacita pevneho ulozeni: pojme i mezivysledky (soucin dvou platnych hodnot, posuny v Karatsubovi)
+    static constexpr std::size_t FixedCapacity = is_unlimited ? 0 : 2 * MaxChunks + 2;
+
+    // Nejvetsi velikost limbu ulozenych primo v objektu (v bajtech), vetsi omezene typy zustavaji na halde
+    // (jinak by lokalni promenne a pomocna pole zabiraly na zasobniku az megabajty)
+    static constexpr std::size_t MaxInlineBytes = 4096;
+    static constexpr bool is_inline = !is_unlimited && FixedCapacity * sizeof(limb_t) <= MaxInlineBytes;
+
+    // Ulozeni chunku volene pri prekladu: pri male omezene presnosti primo v objektu, jinak na halde
+    using storage_t = std::conditional_t<is_inline, MpFixedLimbs<limb_t, FixedCapacity>, std::vector<limb_t>>;
+
+    storage_t chunks;
+    bool is_negative = false;
+
+    // Prahove hodnoty pro prepinani algoritmu nasobeni (v chuncich, namereno na 64bitovych limbech)
+    static constexpr std::size_t NAIVE_THRESHOLD = 1536 / LimbBits;           // Naivni pro mala cisla
+    static constexpr std::size_t KARATSUBA_THRESHOLD = 262144 / LimbBits;     // Karatsuba pro stredni cisla, nad tim Toom-3
+    static constexpr std::size_t TOOM4_THRESHOLD = 393216 / LimbBits;         // Toom-4 pro vetsi cisla
+    static constexpr std::size_t NTT_THRESHOLD = 786432 / LimbBits;           // NTT pro velmi velka cisla (ma prednost pred Toom)
+    static_assert(KARATSUBA_THRESHOLD < TOOM4_THRESHOLD && TOOM4_THRESHOLD < NTT_THRESHOLD, "Kazda uroven nasobeni musi byt dosazitelna");
+
+    // Pomer delek operandu, od nehoz se delsi operand krajeji na useky delky kratsiho
+    static constexpr std::size_t UNBALANCED_RATIO = 2;
+
+    // Prahova hodnota pro skolni umocneni na druhou (ctverec je levnejsi, prechod na Karatsubu nastava pozdeji)
+    static constexpr std::size_t SQUARE_NAIVE_THRESHOLD = 3072 / LimbBits;
+    static_assert(SQUARE_NAIVE_THRESHOLD >= NAIVE_THRESHOLD, "Pomocna pamet Karatsuby je dimenzovana podle NAIVE_THRESHOLD");
+
+    // Paralelni Karatsuba: minimalni velikost (v chuncich) a pocet urovni, jejichz tri podsouciny bezi v poolu vlaken
+    static constexpr std::size_t KARATSUBA_PARALLEL_THRESHOLD = 65536 / LimbBits;
+    static constexpr unsigned KARATSUBA_PARALLEL_DEPTH = 2;
+
+    // Prahova hodnota pro rekurzivni deleni Burnikel-Ziegler (v chuncich delitele i podilu)
+    static constexpr std::size_t BZ_THRESHOLD = 8192 / LimbBits;
+
+    // Prahove hodnoty GCD (v chuncich): od GCD_THRESHOLD se cisla zmensuji polovicnim GCD,
+    // jeho rekurze konci pod HGCD_THRESHOLD Lehmerovymi kroky
+    static constexpr std::size_t GCD_THRESHOLD = 16384 / LimbBits;
+    static constexpr std::size_t HGCD_THRESHOLD = 4096 / LimbBits;
+
+    // Test mocniny: od teto delky odmocniny (v bitech) predchazi 2-adicke odmocnine test rezidui
+    // (namereno na 10^6 bitech: 0.11 s misto 0.26 s bez testu a 0.46 s s testem pro kazde p)
+    static constexpr std::size_t POWER_RESIDUE_THRESHOLD = 4096;
+
+    // Prahova hodnota pro rekurzivni prevod do desitkove soustavy (v chuncich)
+    static constexpr std::size_t TO_STRING_THRESHOLD = 1024 / LimbBits;
+
+    // Prahova hodnota pro rekurzivni prevod z desitkove soustavy (v chuncich vysledku)
+    static constexpr std::size_t FROM_STRING_THRESHOLD = 4096 / LimbBits;
+
+    // Nejvetsi mocnina deseti v jednom chunku (skupina cislic pro prevody mezi soustavami)
+    static constexpr unsigned DecimalChunkDigits = LimbBits == 64 ? 19 : 9;
+    static constexpr limb_t DecimalChunkBase = LimbBits == 64 ? limb_t(10000000000000000000ull) : limb_t(1000000000u);
 
     // Pomocna metoda: Kontrola platne velikosti
-    void ensure_valid_size() const {
+    constexpr void ensure_valid_size() const {
         if constexpr (!is_unlimited) {
             if (chunks.size() > MaxChunks) {
                 throw MpIntOverflowException<MaxBytes>("Preteceni", *this);
             }
+            // Pri 64bitovych limbech muze byt nejvyssi chunk vyuzit jen z poloviny
+            if constexpr (MaxBits % LimbBits != 0) {
+                if (chunks.size() == MaxChunks && (chunks.back() >> (MaxBits % LimbBits)) != 0) {
+                    throw MpIntOverflowException<MaxBytes>("Preteceni", *this);
+                }
+            }
+        }
+    }
+
+    // Pomocna metoda: Pocet bitu absolutni hodnoty (nula ma 0 bitu)
+    constexpr std::size_t bit_length() const {
+        return (chunks.size() - 1) * LimbBits + static_cast<std::size_t>(std::bit_width(chunks.back()));
+    }
+
+    // Pomocna metoda: Zda se vejde kazda hodnota s nejvyse bits bity (pak se kontroly pri vypoctu vynechavaji)
+    static constexpr bool fits_bits(std::size_t bits) {
+        return is_unlimited || bits <= MaxBits;
+    }
+
+    // Pomocna metoda: Predcasne preteceni podle odhadu, vysledek ma alespon min_bits bitu (a nepocita se)
+    static constexpr void check_predicted_bits(std::size_t min_bits) {
+        if constexpr (!is_unlimited) {
+            if (min_bits > MaxBits) {
+                throw MpIntOverflowException<MaxBytes>("Preteceni", min_bits);
+            }
         }
     }
 
+    // Pomocna metoda: Test nuly
+    constexpr bool is_zero() const {
+        return chunks.size() == 1 && chunks[0] == 0;
+    }
+
     // Pomocna metoda: Odstraneni uvodnich nul
-    void remove_leading_zeros() {
+    constexpr void remove_leading_zeros() {
         while (chunks.size() > 1 && chunks.back() == 0) {
             chunks.pop_back();
         }
@@ -61,449 +243,2014 @@ private:
         }
     }
 
-    static int compare_abs(const MpInt& lhs, const MpInt& rhs) {
+    static constexpr int compare_abs(const MpInt& lhs, const MpInt& rhs) {
         if (lhs.chunks.size() != rhs.chunks.size()) {
             return lhs.chunks.size() < rhs.chunks.size() ? -1 : 1;
         }
+        return mp_detail::compare(lhs.limbs(), rhs.limbs());
+    }
 
-        // Hromadne porovnani pomoci memcmp
-        const std::size_t num_chunks = lhs.chunks.size();
-        const uint32_t* lhs_data = lhs.chunks.data();
-        const uint32_t* rhs_data = rhs.chunks.data();
+    // Pomocna metoda: Pohled na chunky jako pole limbu
+    constexpr std::span<const limb_t> limbs() const {
+        return { chunks.data(), chunks.size() };
+    }
 
-        for (std::size_t i = num_chunks; i-- > 0;) {
-            if (lhs_data[i] != rhs_data[i]) {
-                return lhs_data[i] < rhs_data[i] ? -1 : 1;
-            }
+    constexpr std::span<limb_t> limbs() {
+        return { chunks.data(), chunks.size() };
+    }
+
+    // Pomocna metoda: Secteni absolutnich hodnot
+    static constexpr void add_abs(const MpInt& lhs, const MpInt& rhs, MpInt& result) {
+        const MpInt& longer = lhs.chunks.size() >= rhs.chunks.size() ? lhs : rhs;
+        const MpInt& shorter = lhs.chunks.size() >= rhs.chunks.size() ? rhs : lhs;
+        result.chunks.resize(longer.chunks.size());
+
+        const limb_t carry = mp_detail::add({ result.chunks.data(), result.chunks.size() }, longer.limbs(), shorter.limbs());
+        if (carry > 0) {
+            result.chunks.push_back(carry);
         }
+    }
 
-        return 0;
+    // Pomocna metoda: Odecteni absolutnich hodnot (predpoklada |lhs| >= |rhs|)
+    static constexpr void sub_abs(const MpInt& lhs, const MpInt& rhs, MpInt& result) {
+        result.chunks.resize(lhs.chunks.size());
+        mp_detail::sub({ result.chunks.data(), result.chunks.size() }, lhs.limbs(), rhs.limbs());
     }
 
-    static std::map<uint32_t, MpInt<MaxBytes>> initializePrecomputed() {
-        static std::map<uint32_t, MpInt<MaxBytes>> precomputed;
-        if (MaxBytes == std::numeric_limits<std::size_t>::max()) {
-            precomputed = {
-                {50, MpInt<MaxBytes>::from_string("30414093201713378043612608166064768844377641568960512000000000000")},
-                {75, MpInt<MaxBytes>::from_string("24809140811395398091946477116594033660926243886570122837795894512655842677572867409443815424000000000000000000")},
-                {100, MpInt<MaxBytes>::from_string("93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000")},
-                {200, MpInt<MaxBytes>::from_string("788657867364790503552363213932185062295135977687173263294742533244359449963403342920304284011984623904177212138919638830257642790242637105061926624952829931113462857270763317237396988943922445621451664240254033291864131227428294853277524242407573903240321257405579568660226031904170324062351700858796178922222789623703897374720000000000000000000000000000000000000000000000000")},
-            };
+    // Pomocna metoda: Soucet se znamenky, rhs_negative urcuje znamenko druheho operandu
+    static constexpr MpInt signed_add(const MpInt& lhs, const MpInt& rhs, bool rhs_negative) {
+        MpInt result;
+        if (lhs.is_negative == rhs_negative) {
+            add_abs(lhs, rhs, result);
+            result.is_negative = lhs.is_negative;
+        }
+        else if (compare_abs(lhs, rhs) >= 0) {
+            sub_abs(lhs, rhs, result);
+            result.is_negative = lhs.is_negative;
         }
         else {
-            precomputed = {
-                {10, MpInt<MaxBytes>(3628800)},
-                {50, MpInt<MaxBytes>::from_string("30414093201713378043612608166064768844377641568960512000000000000")},
-            };
+            sub_abs(rhs, lhs, result);
+            result.is_negative = rhs_negative;
         }
-        return precomputed;
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
     }
 
-    static MpInt<MaxBytes> productRange(uint32_t low, uint32_t high) {
-        if (low == high) return MpInt<MaxBytes>(low);
-        if (high - low == 1) return MpInt<MaxBytes>(low) * MpInt<MaxBytes>(high);
-        if (high - low < 10) { // Primocary vypocet pro male rozsahy
-            MpInt<MaxBytes> result(low);
-            for (uint32_t i = low + 1; i <= high; ++i) {
-                result = result * MpInt<MaxBytes>(i);
+    // Pomocna metoda: Pricteni se znamenkem na miste, other_negative urcuje znamenko druheho operandu (other muze byt *this)
+    constexpr void add_signed_in_place(const MpInt& other, bool other_negative) {
+        if (is_negative == other_negative) {
+            if (chunks.size() < other.chunks.size()) {
+                chunks.resize(other.chunks.size(), 0);
             }
-            return result;
+            const limb_t carry = mp_detail::add_into(limbs(), other.limbs());
+            if (carry > 0) {
+                chunks.push_back(carry);
+            }
+        }
+        else if (compare_abs(*this, other) >= 0) {
+            mp_detail::sub_into(limbs(), other.limbs());
+        }
+        else {
+            // |other| - |this| do stavajiciho ulozeni (odcitani po limbech muze prepisovat operand)
+            chunks.resize(other.chunks.size(), 0);
+            mp_detail::sub(limbs(), other.limbs(), limbs());
+            is_negative = other_negative;
         }
+        remove_leading_zeros();
+        ensure_valid_size();
+    }
+
+    // Pomocna metoda: Pricteni jednoho limbu se znamenkem na miste (bez docasneho MpInt)
+    constexpr void add_limb_in_place(limb_t value, bool value_negative) {
+        if (value == 0) return;
+        if (is_zero()) {
+            chunks[0] = value;
+            is_negative = value_negative;
+        }
+        else if (is_negative == value_negative) {
+            const limb_t carry = mp_detail::add_1(limbs(), value);
+            if (carry > 0) {
+                chunks.push_back(carry);
+            }
+        }
+        else if (chunks.size() > 1 || chunks[0] >= value) {
+            mp_detail::sub_1(limbs(), value);
+        }
+        else {
+            chunks[0] = value - chunks[0];
+            is_negative = value_negative;
+        }
+        remove_leading_zeros();
+        ensure_valid_size();
+    }
+
+    // Pomocna metoda: Absolutni hodnota int jako limb
+    static constexpr limb_t int_magnitude(int value) {
+        return value < 0 ? 0 - static_cast<limb_t>(value) : static_cast<limb_t>(value);
+    }
 
-        const uint32_t mid = (low + high) / 2;
+    // Pomocna metoda: Soucin a * b (pripadne s obracenym znamenkem) s volitelnym pricitanim addend do tehoz vysledku
+    // (pritomnost scitance je parametr sablony, porovnani adresy docasneho objektu s nullptr GCC za prekladu neumi)
+    template <bool WithAddend>
+    static constexpr MpInt fused_multiply(const MpInt& a, const MpInt& b, bool negate_product, const MpInt* addend, bool addend_negative) {
+        const bool product_negative = (a.is_negative != b.is_negative) != negate_product;
+        const MpInt& longer = a.chunks.size() >= b.chunks.size() ? a : b;
+        const MpInt& shorter = a.chunks.size() >= b.chunks.size() ? b : a;
+
+        // Odhad z delek operandu: soucin ma bx + by - 1 nebo bx + by bitu, bez scitance opacneho znamenka
+        // se tedy preteceni pozna pred nasobenim
+        const bool fused = WithAddend && product_negative == addend_negative;
+        const std::size_t product_bits = a.is_zero() || b.is_zero() ? 0 : a.bit_length() + b.bit_length();
+        if (!WithAddend || fused) {
+            check_predicted_bits(product_bits - (product_bits > 0));
+        }
 
-        // Pouziti vicevlaken pro velke rozsahy
-        if (high - low > 20) {
-            std::future<MpInt<MaxBytes>> left_part = std::async(std::launch::async, productRange, low, mid);
-            const MpInt<MaxBytes> right_part = productRange(mid + 1, high);
-            return left_part.get() * right_part;
+        MpInt result;
+        if ((fused && shorter.chunks.size() < NAIVE_THRESHOLD) || std::is_constant_evaluated()) {
+            // Skolni nasobeni primo nad kopii scitance: radky soucinu se pricitaji do vysledku
+            // (pri vyhodnoceni za prekladu vzdy, rychlejsi algoritmy nejsou constexpr)
+            result.chunks.resize(std::max(longer.chunks.size() + shorter.chunks.size(), fused ? addend->chunks.size() : 0) + 1, 0);
+            if (fused) {
+                std::copy(addend->chunks.begin(), addend->chunks.end(), result.chunks.begin());
+            }
+            const std::span<limb_t> accumulator = result.limbs();
+            for (std::size_t i = 0; i < shorter.chunks.size(); ++i) {
+                if (shorter.chunks[i] == 0) continue;
+                const limb_t carry = mp_detail::addmul_1(accumulator.subspan(i), longer.limbs(), shorter.chunks[i]);
+                mp_detail::add_into(accumulator.subspan(i + longer.chunks.size()), std::span<const limb_t>(&carry, 1));
+            }
+            result.is_negative = product_negative;
+            if constexpr (WithAddend) {
+                if (!fused) {
+                    result.remove_leading_zeros();
+                    result.add_signed_in_place(*addend, addend_negative);
+                }
+            }
         }
         else {
-            // Sekvencni vypocet pro male rozsahy
-            return productRange(low, mid) * productRange(mid + 1, high);
+            // Stejne operandy (i ruzne objekty) se umocnuji specialnimi jadry
+            result = (&a == &b || a.chunks == b.chunks) ? hybridSquare(a) : a.hybridMultiply(longer, shorter);
+            result.is_negative = product_negative;
+            if constexpr (WithAddend) {
+                result.add_signed_in_place(*addend, addend_negative);
+            }
+        }
+
+        result.remove_leading_zeros();
+        if (WithAddend || !fits_bits(product_bits)) {
+            result.ensure_valid_size();
         }
+        return result;
     }
 
-public:
-    static constexpr std::size_t Unlimited = std::numeric_limits<std::size_t>::max();
+    // Pomocna metoda: Nevyvazeny soucin, useky delsiho operandu delky |shorter| se nasobi vyvazene
+    // a pricitaji na sve misto (pri vice vlaknech se useky nasobi soubezne)
+    static MpInt multiply_unbalanced(const MpInt& longer, const MpInt& shorter) {
+        const std::size_t piece_size = shorter.chunks.size();
+        const std::size_t pieces = (longer.chunks.size() + piece_size - 1) / piece_size;
+        const auto piece_product = [&](std::size_t i) {
+            return MpInt().hybridMultiply(limb_slice(longer, i * piece_size, piece_size), shorter);
+        };
+
+        std::vector<MpInt> products(pieces);
+        MpThreadPool& pool = MpThreadPool::instance();
+        if (pool.thread_count() > 1) {
+            std::vector<std::future<MpInt>> pending;
+            pending.reserve(pieces - 1);
+            for (std::size_t i = 1; i < pieces; ++i) {
+                pending.push_back(pool.submit([&piece_product, i] { return piece_product(i); }));
+            }
+            products[0] = piece_product(0);
+            for (std::size_t i = 1; i < pieces; ++i) {
+                products[i] = pool.wait(pending[i - 1]);
+            }
+        }
+        else {
+            for (std::size_t i = 0; i < pieces; ++i) {
+                products[i] = piece_product(i);
+            }
+        }
 
-    // Zakladni konstruktor
-    MpInt() : chunks(1, 0), is_negative(false) {}
+        MpInt result;
+        result.chunks.assign(longer.chunks.size() + piece_size, 0);
+        for (std::size_t i = 0; i < pieces; ++i) {
+            mp_detail::add_into(result.limbs().subspan(i * piece_size), products[i].limbs());
+        }
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
+    }
 
-    // Konstruktor z celociselne hodnoty
-    explicit MpInt(int64_t value) {
-        is_negative = value < 0;
-        uint64_t abs_value = is_negative ? -value : value;
-        while (abs_value > 0) {
-            chunks.push_back(static_cast<uint32_t>(abs_value & 0xFFFFFFFF));
-            abs_value >>= 32;
+    // Pomocna metoda: Vyrez chunku [from, from + count) jako nezaporne cislo
+    static MpInt limb_slice(const MpInt& x, std::size_t from, std::size_t count) {
+        const std::size_t size = x.chunks.size();
+        const std::size_t begin = std::min(from, size);
+        const std::size_t end = std::min(from + count, size);
+        return MpInt(x.chunks.begin() + begin, x.chunks.begin() + end);
+    }
+
+    // Pomocna metoda: Rozdeleni na parts casti po part_size chuncich (od nejnizsi)
+    static std::vector<MpInt> split_limbs(const MpInt& x, std::size_t parts, std::size_t part_size) {
+        std::vector<MpInt> result;
+        result.reserve(parts);
+        for (std::size_t i = 0; i < parts; ++i) {
+            result.push_back(limb_slice(x, i * part_size, part_size));
         }
-        if (chunks.empty()) {
-            chunks.push_back(0);
+        return result;
+    }
+
+    // Pomocna metoda: Pricteni nezaporneho dilu posunuteho o offset chunku
+    static void add_shifted(MpInt& acc, const MpInt& part, std::size_t offset) {
+        if (part.is_zero()) return;
+
+        const std::size_t part_size = part.chunks.size();
+        if (acc.chunks.size() < offset + part_size) {
+            acc.chunks.resize(offset + part_size, 0);
+        }
+
+        limb_t carry = 0;
+        std::size_t i = 0;
+        for (; i < part_size; ++i) {
+            acc.chunks[offset + i] = mp_detail::add_carry(acc.chunks[offset + i], part.chunks[i], carry);
+        }
+        for (std::size_t j = offset + i; carry > 0; ++j) {
+            if (j == acc.chunks.size()) {
+                acc.chunks.push_back(carry);
+                break;
+            }
+            acc.chunks[j] = mp_detail::add_carry(acc.chunks[j], 0, carry);
         }
     }
 
-    // Konstruktor z iteratoru
-    template <std::input_iterator InputIt>
-    MpInt(InputIt first, InputIt last) : chunks(first, last), is_negative(false) {
-        if (!is_unlimited && chunks.size() > MaxChunks) {
-            throw MpIntOverflowException<MaxBytes>("Prekrocen maximalni pocet chunku", *this);
+    // Pomocna metoda: Slozeni vysledku z nezapornych koeficientu polynomu v bode 2^(part_size * LimbBits)
+    static MpInt combine_parts(const std::vector<MpInt>& coefficients, std::size_t part_size) {
+        MpInt result;
+        for (std::size_t i = 0; i < coefficients.size(); ++i) {
+            add_shifted(result, coefficients[i], i * part_size);
         }
-        remove_leading_zeros();
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
     }
 
-    // Kopirovaci konstruktor
-    MpInt(const MpInt& other) = default;
+    // Pomocna metoda: Vyhodnoceni polynomu s koeficienty parts v malem celem bode (Hornerovo schema)
+    static MpInt evaluate_at(const std::vector<MpInt>& parts, int64_t point) {
+        MpInt value = parts.back();
+        for (std::size_t i = parts.size() - 1; i-- > 0;) {
+            value *= static_cast<int>(point);
+            value += parts[i];
+        }
+        return value;
+    }
 
-    // Presunovaci konstruktor
-    MpInt(MpInt&& other) noexcept = default;
+    // Pomocna metoda: Presne deleni malym cislem se zachovanim znamenka (interpolace v Toom-Cook)
+    static MpInt divide_exact(const MpInt& value, uint32_t divisor) {
+        MpInt quotient = value;
+        quotient.divmod_small(divisor);
+        return quotient;
+    }
 
-    // Kopirovaci operator prirazeni
-    MpInt& operator=(const MpInt& other) = default;
+    // Pomocna metoda: Deleni absolutnich hodnot Knuthovym algoritmem D (predpoklada |u| >= |v| > 0)
+    static void divmod_knuth(const MpInt& u, const MpInt& v, MpInt& quotient, MpInt& remainder) {
+        const std::size_t n = v.chunks.size();
+        const std::size_t m = u.chunks.size() - n;
+        quotient.is_negative = false;
+        remainder.is_negative = false;
+        quotient.chunks.assign(m + 1, 0);
 
-    // Presunovaci operator prirazeni
-    MpInt& operator=(MpInt&& other) noexcept = default;
+        if (n == 1) {
+            const limb_t rest = mp_detail::divrem_1(quotient.limbs(), u.limbs(), v.chunks[0]);
+            remainder.chunks.assign(1, rest);
+        }
+        else {
+            // Normalizace: nejvyssi bit delitele musi byt nastaven
+            const unsigned shift = static_cast<unsigned>(std::countl_zero(v.chunks.back()));
+            MpInt divisor;
+            divisor.chunks.resize(n);
+            mp_detail::lshift(divisor.limbs(), v.limbs(), shift);
 
-    // Operator scitani
-    template <std::size_t OtherMaxBytes>
-    MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> operator+(const MpInt<OtherMaxBytes>& other) const {
-        if (is_negative == other.is_negative) {
-            MpInt result;
-            result.is_negative = is_negative;
-            const std::size_t max_size = std::max(chunks.size(), other.chunks.size());
-            result.chunks.resize(max_size, 0);
-
-            uint64_t carry = 0;
-            for (std::size_t i = 0; i < max_size || carry > 0; ++i) {
-                const uint64_t lhs_chunk = i < chunks.size() ? chunks[i] : 0;
-                const uint64_t rhs_chunk = i < other.chunks.size() ? other.chunks[i] : 0;
-                const uint64_t sum = lhs_chunk + rhs_chunk + carry;
-
-                if (i >= result.chunks.size()) {
-                    result.chunks.push_back(static_cast<uint32_t>(sum));
-                }
-                else {
-                    result.chunks[i] = static_cast<uint32_t>(sum);
-                }
-                carry = sum >> 32;
+            remainder.chunks.resize(m + n + 1);
+            const std::span<limb_t> un = remainder.limbs();
+            un[m + n] = mp_detail::lshift(un.first(m + n), u.limbs(), shift);
+
+            mp_detail::divrem_knuth(quotient.limbs(), un, divisor.limbs());
+
+            // Zbytek je v dolnich n limbech, zpetny posun
+            mp_detail::rshift(un.first(n), un.first(n), shift);
+            remainder.chunks.resize(n);
+        }
+
+        quotient.remove_leading_zeros();
+        remainder.remove_leading_zeros();
+    }
+
+    // Pomocna metoda: Burnikel-Ziegler 2n/1n, predpoklada a < b * B^n a normalizovany b s n chunky
+    static void bz_div_2n_1n(const MpInt& a, const MpInt& b, std::size_t n, MpInt& quotient, MpInt& remainder) {
+        if (n < BZ_THRESHOLD) {
+            if (compare_abs(a, b) < 0) {
+                quotient = MpInt();
+                remainder = a;
+            }
+            else {
+                divmod_knuth(a, b, quotient, remainder);
             }
+            return;
+        }
 
-            result.ensure_valid_size();
-            return result;
+        // Licha delka: rozsireni o jeden chunk (normalizace se zachova), zbytek se pak posune zpet
+        if (n & 1) {
+            bz_div_2n_1n(a << LimbBits, b << LimbBits, n + 1, quotient, remainder);
+            remainder.rightShift(LimbBits);
+            return;
+        }
+
+        const std::size_t half = n / 2;
+        const MpInt b_high = limb_slice(b, half, half);
+        const MpInt b_low = limb_slice(b, 0, half);
+
+        MpInt q_high;
+        MpInt rest;
+        bz_div_3n_2n(limb_slice(a, n, a.chunks.size()), limb_slice(a, half, half), b, b_high, b_low, half, q_high, rest);
+        bz_div_3n_2n(rest, limb_slice(a, 0, half), b, b_high, b_low, half, quotient, remainder);
+        add_shifted(quotient, q_high, half);
+    }
+
+    // Pomocna metoda: Burnikel-Ziegler 3n/2n, deli (a12 * B^n + a3) delitelem b = b_high * B^n + b_low
+    static void bz_div_3n_2n(const MpInt& a12, const MpInt& a3, const MpInt& b, const MpInt& b_high, const MpInt& b_low,
+        std::size_t n, MpInt& quotient, MpInt& remainder) {
+        MpInt rest;
+        if (limb_slice(a12, n, a12.chunks.size()) == b_high) {
+            // Odhad podilu B^n - 1
+            quotient.chunks.assign(n, ~limb_t(0));
+            quotient.is_negative = false;
+            rest = a12 - (b_high << static_cast<uint32_t>(n * LimbBits)) + b_high;
         }
         else {
-            return *this - (-other);
+            bz_div_2n_1n(a12, b_high, n, quotient, rest);
+        }
+
+        // Zbytek = rest * B^n + a3 - quotient * b_low, odhad podilu je nejvyse o dva vetsi
+        MpInt extended = a3;
+        add_shifted(extended, rest, n);
+        remainder = fused_multiply<true>(quotient, b_low, true, &extended, extended.is_negative);
+        while (remainder.is_negative) {
+            quotient.sub_small(1);
+            remainder += b;
         }
     }
 
-    // Operator scitani s int
-    MpInt operator+(int value) const {
-        return *this + MpInt(value);
+    // Pomocna metoda: Rekurzivni deleni Burnikel-Ziegler pro velke operandy (predpoklada |u| >= |v| > 0)
+    static void divmod_bz(const MpInt& u, const MpInt& v, MpInt& quotient, MpInt& remainder) {
+        // Normalizace: nejvyssi bit delitele musi byt nastaven
+        const uint32_t shift = static_cast<uint32_t>(std::countl_zero(v.chunks.back()));
+        MpInt divisor = v;
+        divisor.is_negative = false;
+        divisor.leftShift(shift);
+        MpInt dividend = u;
+        dividend.is_negative = false;
+        dividend.leftShift(shift);
+
+        // Skolni deleni v soustave o zakladu B^n, kazda cifra pres 2n/1n krok
+        const std::size_t n = divisor.chunks.size();
+        const std::size_t blocks = (dividend.chunks.size() + n - 1) / n;
+        MpInt rest;
+        quotient = MpInt();
+        for (std::size_t i = blocks; i-- > 0;) {
+            MpInt block = limb_slice(dividend, i * n, n);
+            add_shifted(block, rest, n);
+            MpInt q_block;
+            bz_div_2n_1n(block, divisor, n, q_block, rest);
+            add_shifted(quotient, q_block, i * n);
+        }
+
+        quotient.remove_leading_zeros();
+        rest.rightShift(shift);
+        remainder = rest;
     }
 
-    // Operator odcitani
-    template <std::size_t OtherMaxBytes>
-    MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> operator-(const MpInt<OtherMaxBytes>& other) const {
-        if (is_negative != other.is_negative) {
-            return *this + (-other);
+    // Pomocna metoda: Deleni absolutnich hodnot, volba algoritmu podle velikosti (predpoklada |u| >= |v| > 0)
+    // Normalizace a mezivysledky Burnikel-Ziegler mohou presahnout MaxBits, omezeny typ je pocita v neomezene presnosti
+    static void divmod_abs(const MpInt& u, const MpInt& v, MpInt& quotient, MpInt& remainder) {
+        const std::size_t divisor_size = v.chunks.size();
+        const std::size_t quotient_size = u.chunks.size() - divisor_size + 1;
+        if (divisor_size >= BZ_THRESHOLD && quotient_size >= BZ_THRESHOLD) {
+            if constexpr (is_unlimited) {
+                divmod_bz(u, v, quotient, remainder);
+            }
+            else {
+                using Wide = MpInt<Unlimited>;
+                Wide wide_quotient;
+                Wide wide_remainder;
+                Wide::divmod_bz(widen<Unlimited>(u), widen<Unlimited>(v), wide_quotient, wide_remainder);
+                quotient = narrow(wide_quotient, MpOverflowMode::Throw);
+                remainder = narrow(wide_remainder, MpOverflowMode::Throw);
+            }
+        }
+        else {
+            divmod_knuth(u, v, quotient, remainder);
+        }
+    }
+
+    // Pomocna metoda: Mocnina 10^(DecimalChunkDigits * 2^k) ze sdilene cache (dopocitava se lina)
+    // Ctverec se pocita bez zamku: velke nasobeni ceka na pool a to muze spustit cizi prevod, ktery cache take pouziva
+    static const MpInt& decimal_power(std::size_t k) {
+        static std::deque<MpInt> powers;
+        static std::mutex guard;
+
+        std::unique_lock<std::mutex> lock(guard);
+        if (powers.empty()) {
+            powers.emplace_back(&DecimalChunkBase, &DecimalChunkBase + 1);
+        }
+        while (powers.size() <= k) {
+            // Prvky deque se pri pridavani na konec nepresouvaji, reference zustava platna i bez zamku
+            const MpInt& last = powers.back();
+            const std::size_t next = powers.size();
+            lock.unlock();
+            MpInt square = last.square();
+            lock.lock();
+            if (powers.size() == next) {
+                powers.push_back(std::move(square));
+            }
+        }
+        return powers[k];
+    }
+
+    // Pomocna metoda: Zapis nezaporne hodnoty jako presne digits cislic (s uvodnimi nulami) po skupinach cislic
+    static void write_decimal_basecase(const MpInt& value, char* out, std::size_t digits) {
+        std::vector<limb_t> work(value.chunks.begin(), value.chunks.end());
+        std::size_t size = mp_detail::normalized(work).size();
+        char* position = out + digits;
+
+        while (size > 0) {
+            const std::span<limb_t> active(work.data(), size);
+            limb_t group = mp_detail::divrem_1(active, active, DecimalChunkBase);
+            size = mp_detail::normalized(active).size();
+            for (unsigned i = 0; i < DecimalChunkDigits; ++i) {
+                *--position = static_cast<char>('0' + group % 10);
+                group /= 10;
+            }
+        }
+        std::fill(out, position, '0');
+    }
+
+    // Pomocna metoda: Rekurzivni zapis hodnoty < 10^(DecimalChunkDigits * 2^level) deleni napul mocninou deseti
+    static void write_decimal(const MpInt& value, std::size_t level, char* out) {
+        const std::size_t digits = std::size_t(DecimalChunkDigits) << level;
+        if (level == 0 || value.chunks.size() <= TO_STRING_THRESHOLD) {
+            write_decimal_basecase(value, out, digits);
+            return;
         }
 
-        if (compare_abs(*this, other) < 0) {
-            return -(other - *this);
+        const MpInt& power = decimal_power(level - 1);
+        if (compare_abs(value, power) < 0) {
+            std::fill(out, out + digits / 2, '0');
+            write_decimal(value, level - 1, out + digits / 2);
+            return;
+        }
+
+        MpInt high;
+        MpInt low;
+        divmod_abs(value, power, high, low);
+        write_decimal(high, level - 1, out);
+        write_decimal(low, level - 1, out + digits / 2);
+    }
+
+    // Pomocna metoda: Nasobeni jednim limbem a pricteni limbu na miste (value = value * multiplier + addend),
+    // Checked = false vynecha kontrolu velikosti, kdyz se vysledek vejde zarucene
+    template <bool Checked = true>
+    constexpr void mul_add_limb(limb_t multiplier, limb_t addend) {
+        limb_t carry = addend;
+        for (limb_t& chunk : chunks) {
+            chunk = mp_detail::mul_add(chunk, multiplier, carry, 0, carry);
         }
+        if (carry != 0) {
+            chunks.push_back(carry);
+            if constexpr (Checked) {
+                ensure_valid_size();
+            }
+        }
+    }
 
+    // Pomocna metoda: Prevod desitkovych cislic po skupinach DecimalChunkDigits cislic (jedno nasobeni limbem na skupinu)
+    static MpInt parse_decimal_basecase(const char* digits, std::size_t length) {
         MpInt result;
-        result.is_negative = is_negative;
-        result.chunks.resize(chunks.size(), 0);
+        std::size_t block = length % DecimalChunkDigits;
+        if (block == 0) {
+            block = DecimalChunkDigits;
+        }
+
+        for (std::size_t position = 0; position < length; position += block, block = DecimalChunkDigits) {
+            limb_t value = 0;
+            limb_t multiplier = 1;
+            for (std::size_t i = 0; i < block; ++i) {
+                value = value * 10 + static_cast<limb_t>(digits[position + i] - '0');
+                multiplier *= 10;
+            }
+            result.mul_add_limb(multiplier, value);
+        }
+        return result;
+    }
+
+    // Pomocna metoda: Rekurzivni prevod desitkovych cislic, spodni cast ma DecimalChunkDigits * 2^k cislic
+    static MpInt parse_decimal(const char* digits, std::size_t length) {
+        if (length <= FROM_STRING_THRESHOLD * DecimalChunkDigits) {
+            return parse_decimal_basecase(digits, length);
+        }
+
+        std::size_t level = 0;
+        while ((std::size_t(DecimalChunkDigits) << (level + 1)) < length) {
+            ++level;
+        }
+        const std::size_t low_length = std::size_t(DecimalChunkDigits) << level;
+
+        MpInt result = parse_decimal(digits, length - low_length) * decimal_power(level);
+        add_shifted(result, parse_decimal(digits + length - low_length, low_length), 0);
+        return result;
+    }
+
+    // Pomocna metoda: Hodnota sestnactkove cislice
+    static limb_t hex_digit_value(char digit) {
+        if (digit >= '0' && digit <= '9') return static_cast<limb_t>(digit - '0');
+        if (digit >= 'a' && digit <= 'f') return static_cast<limb_t>(digit - 'a' + 10);
+        if (digit >= 'A' && digit <= 'F') return static_cast<limb_t>(digit - 'A' + 10);
+        throw std::invalid_argument(std::string("Neplatna sestnactkova cislice: ") + digit);
+    }
+
+    // Pomocna metoda: Velikost pomocne pameti pro Karatsubovu rekurzi nad operandy s nejvyse n chunky
+    static std::size_t karatsuba_scratch_size(std::size_t n) {
+        std::size_t total = 0;
+        while (n >= NAIVE_THRESHOLD) {
+            const std::size_t half = (n + 1) / 2;
+            total += 4 * half + 4;
+            n = half + 1;
+        }
+        return total;
+    }
+
+    // Pomocna metoda: Karatsubova rekurze nad poli limbu bez alokaci
+    // result ma |x| + |y| limbu, mezivysledky se ukladaji do predalokovaneho scratch
+    static void karatsuba_limbs(std::span<limb_t> result, std::span<const limb_t> x, std::span<const limb_t> y,
+        std::span<limb_t> scratch) {
+        if (x.size() < y.size()) {
+            std::swap(x, y);
+        }
+        const std::size_t n = x.size();
+        const std::size_t m = y.size();
+
+        if (m < NAIVE_THRESHOLD) {
+            mp_detail::mul_basecase(result, x, y);
+            return;
+        }
+
+        const std::size_t half = (n + 1) / 2;
+
+        // Nevyvazene operandy: x_low * y a x_high * y zvlast, druhy soucin se pricte na sve misto
+        if (m <= half) {
+            karatsuba_limbs(result.first(half + m), x.first(half), y, scratch);
+            std::fill(result.begin() + half + m, result.end(), 0);
+            const std::span<limb_t> high = scratch.first(n - half + m);
+            karatsuba_limbs(high, x.subspan(half), y, scratch.subspan(high.size()));
+            mp_detail::add_into(result.subspan(half), high);
+            return;
+        }
+
+        const std::span<const limb_t> x_low = x.first(half);
+        const std::span<const limb_t> x_high = x.subspan(half);
+        const std::span<const limb_t> y_low = y.first(half);
+        const std::span<const limb_t> y_high = y.subspan(half);
+
+        // z0 a z2 primo na sva mista ve vysledku
+        karatsuba_limbs(result.first(2 * half), x_low, y_low, scratch);
+        karatsuba_limbs(result.subspan(2 * half), x_high, y_high, scratch);
+
+        // Soucty polovin (horni limb jen pri prenosu)
+        const std::span<limb_t> x_sum = scratch.first(half + 1);
+        const std::span<limb_t> y_sum = scratch.subspan(half + 1, half + 1);
+        x_sum[half] = mp_detail::add(x_sum.first(half), x_low, x_high);
+        y_sum[half] = mp_detail::add(y_sum.first(half), y_low, y_high);
+        const std::span<const limb_t> x_mid = x_sum.first(half + (x_sum[half] != 0));
+        const std::span<const limb_t> y_mid = y_sum.first(half + (y_sum[half] != 0));
+
+        // z1 = (x_low + x_high)(y_low + y_high) - z0 - z2, pricteno na pozici half
+        const std::span<limb_t> z1 = scratch.subspan(2 * half + 2, x_mid.size() + y_mid.size());
+        karatsuba_limbs(z1, x_mid, y_mid, scratch.subspan(4 * half + 4));
+        mp_detail::sub_into(z1, result.first(2 * half));
+        mp_detail::sub_into(z1, result.subspan(2 * half));
+        mp_detail::add_into(result.subspan(half), mp_detail::normalized(z1));
+    }
+
+    // Pomocna metoda: Karatsubovo umocneni na druhou, tri rekurzivni ctverce misto obecnych soucinu
+    // result ma 2|x| limbu, pomocna pamet ma stejne rozlozeni jako u karatsuba_limbs
+    static void karatsuba_square_limbs(std::span<limb_t> result, std::span<const limb_t> x, std::span<limb_t> scratch) {
+        const std::size_t n = x.size();
+        if (n < SQUARE_NAIVE_THRESHOLD) {
+            mp_detail::sqr_basecase(result, x);
+            return;
+        }
+
+        const std::size_t half = (n + 1) / 2;
+        const std::span<const limb_t> x_low = x.first(half);
+        const std::span<const limb_t> x_high = x.subspan(half);
+
+        karatsuba_square_limbs(result.first(2 * half), x_low, scratch);
+        karatsuba_square_limbs(result.subspan(2 * half), x_high, scratch);
+
+        const std::span<limb_t> x_sum = scratch.first(half + 1);
+        x_sum[half] = mp_detail::add(x_sum.first(half), x_low, x_high);
+        const std::span<const limb_t> x_mid = x_sum.first(half + (x_sum[half] != 0));
+
+        // z1 = (x_low + x_high)^2 - z0 - z2, pricteno na pozici half
+        const std::span<limb_t> z1 = scratch.subspan(2 * half + 2, 2 * x_mid.size());
+        karatsuba_square_limbs(z1, x_mid, scratch.subspan(4 * half + 4));
+        mp_detail::sub_into(z1, result.first(2 * half));
+        mp_detail::sub_into(z1, result.subspan(2 * half));
+        mp_detail::add_into(result.subspan(half), mp_detail::normalized(z1));
+    }
 
-        int64_t borrow = 0;
-        for (std::size_t i = 0; i < chunks.size(); ++i) {
-            const int64_t lhs_chunk = chunks[i];
-            const int64_t rhs_chunk = i < other.chunks.size() ? other.chunks[i] : 0;
-            int64_t diff = lhs_chunk - rhs_chunk - borrow;
+    // Pomocna metoda: Horni urovne Karatsuby, tri nezavisle podsouciny bezi paralelne ve sdilenem poolu vlaken
+    // Kazda uloha ma vlastni pomocnou pamet, pod urovni depth nebo prahem pokracuje sekvencni karatsuba_limbs
+    static void karatsuba_parallel(std::span<limb_t> result, std::span<const limb_t> x, std::span<const limb_t> y,
+        unsigned depth) {
+        if (x.size() < y.size()) {
+            std::swap(x, y);
+        }
+        const std::size_t half = (x.size() + 1) / 2;
+        const bool square = x.data() == y.data() && x.size() == y.size();
 
-            if (diff < 0) {
-                diff += (1LL << 32);
-                borrow = 1;
+        if (depth == 0 || y.size() <= half || y.size() < KARATSUBA_PARALLEL_THRESHOLD) {
+            std::vector<limb_t> scratch(karatsuba_scratch_size(x.size()));
+            if (square) {
+                karatsuba_square_limbs(result, x, scratch);
             }
             else {
-                borrow = 0;
+                karatsuba_limbs(result, x, y, scratch);
             }
-            result.chunks[i] = static_cast<uint32_t>(diff);
+            return;
         }
 
-        result.remove_leading_zeros();
-        result.ensure_valid_size();
-        return result;
+        const std::span<const limb_t> x_low = x.first(half);
+        const std::span<const limb_t> x_high = x.subspan(half);
+        const std::span<const limb_t> y_low = square ? x_low : y.first(half);
+        const std::span<const limb_t> y_high = square ? x_high : y.subspan(half);
+
+        // Pri umocnovani sdili obe strany tytez polovinove soucty (podvolani pak take umocnuji)
+        std::vector<limb_t> sums(2 * half + 2);
+        const std::span<limb_t> x_sum(sums.data(), half + 1);
+        const std::span<limb_t> y_sum(sums.data() + half + 1, half + 1);
+        x_sum[half] = mp_detail::add(x_sum.first(half), x_low, x_high);
+        const std::span<const limb_t> x_mid = x_sum.first(half + (x_sum[half] != 0));
+        std::span<const limb_t> y_mid = x_mid;
+        if (!square) {
+            y_sum[half] = mp_detail::add(y_sum.first(half), y_low, y_high);
+            y_mid = y_sum.first(half + (y_sum[half] != 0));
+        }
+
+        // z0 a z2 jako ulohy poolu, z1 v aktualnim vlakne
+        MpThreadPool& pool = MpThreadPool::instance();
+        std::future<void> low = pool.submit([&] { karatsuba_parallel(result.first(2 * half), x_low, y_low, depth - 1); });
+        std::future<void> high = pool.submit([&] { karatsuba_parallel(result.subspan(2 * half), x_high, y_high, depth - 1); });
+        std::vector<limb_t> z1(x_mid.size() + y_mid.size());
+        karatsuba_parallel(z1, x_mid, y_mid, depth - 1);
+        pool.wait(low);
+        pool.wait(high);
+
+        mp_detail::sub_into(z1, result.first(2 * half));
+        mp_detail::sub_into(z1, result.subspan(2 * half));
+        mp_detail::add_into(result.subspan(half), mp_detail::normalized(z1));
     }
 
-    // Naivni nasobeni pro male vstupy
-    MpInt naiveMultiply(const MpInt& other) const {
-        MpInt result;
-        result.chunks.resize(chunks.size() + other.chunks.size(), 0);
+    // Faktorialy malych cisel (20! je nejvetsi, ktery se vejde do int64_t)
+    static constexpr std::array<int64_t, 21> SmallFactorials = [] {
+        std::array<int64_t, 21> table{};
+        table[0] = 1;
+        for (std::size_t i = 1; i < table.size(); ++i) {
+            table[i] = table[i - 1] * static_cast<int64_t>(i);
+        }
+        return table;
+    }();
+
+    // Pocet limbu, ktere se v soucinu seznamu nasobi postupne (bez deleni napul)
+    static constexpr std::size_t PRODUCT_LEAF_SIZE = 16;
+
+    // Od tohoto poctu limbu se polovina soucinu seznamu pocita jako uloha poolu vlaken
+    static constexpr std::size_t PRODUCT_PARALLEL_SIZE = 1024;
+
+    // Pomocna metoda: Prvocisla <= n (Eratosthenovo sito nad lichymi cisly)
+    static std::vector<uint32_t> primes_up_to(uint32_t n) {
+        std::vector<uint32_t> primes;
+        if (n < 2) return primes;
+        primes.push_back(2);
+
+        // Index i odpovida cislu 2i + 1
+        std::vector<bool> composite(n / 2 + 1, false);
+        for (uint64_t i = 1; 2 * i + 1 <= n; ++i) {
+            if (composite[i]) continue;
+            const uint64_t p = 2 * i + 1;
+            primes.push_back(static_cast<uint32_t>(p));
+            for (uint64_t multiple = p * p; multiple <= n; multiple += 2 * p) {
+                composite[multiple / 2] = true;
+            }
+        }
+        return primes;
+    }
 
-        for (std::size_t i = 0; i < chunks.size(); ++i) {
-            uint64_t carry = 0;
-            for (std::size_t j = 0; j < other.chunks.size() || carry > 0; ++j) {
-                const uint64_t product = result.chunks[i + j] +
-                    static_cast<uint64_t>(chunks[i]) * (j < other.chunks.size() ? other.chunks[j] : 0) +
-                    carry;
-                result.chunks[i + j] = static_cast<uint32_t>(product);
-                carry = product >> 32;
+    // Pomocna metoda: Vyvazeny soucin limbu (binarni deleni, listy se nasobi jednim limbem na miste)
+    static MpInt product_limbs(const limb_t* factors, std::size_t count) {
+        if (count <= PRODUCT_LEAF_SIZE) {
+            MpInt result;
+            result.chunks.assign(1, count == 0 ? 1 : factors[0]);
+            for (std::size_t i = 1; i < count; ++i) {
+                result.mul_add_limb(factors[i], 0);
+            }
+            return result;
+        }
+
+        const std::size_t half = count / 2;
+        MpThreadPool& pool = MpThreadPool::instance();
+        if (count >= PRODUCT_PARALLEL_SIZE && pool.thread_count() > 1) {
+            std::future<MpInt> low = pool.submit([=] { return product_limbs(factors, half); });
+            const MpInt high = product_limbs(factors + half, count - half);
+            return pool.wait(low) * high;
+        }
+        return product_limbs(factors, half) * product_limbs(factors + half, count - half);
+    }
+
+    // Pomocna metoda: Pridani cinitele do seznamu limbu, cinitele se nasobi do limbu, dokud se do nej vejdou
+    static void push_packed_factor(std::vector<limb_t>& factors, limb_t& packed, limb_t factor) {
+        if (packed > std::numeric_limits<limb_t>::max() / factor) {
+            factors.push_back(packed);
+            packed = 1;
+        }
+        packed *= factor;
+    }
+
+    // Pomocna metoda: Licha cast "swing" cisla n!/((n/2)!)^2 jako soucin mocnin lichych prvocisel
+    static MpInt odd_swing(uint32_t n, const std::vector<uint32_t>& primes) {
+        // Mocnina prvocisla ve swing cisle je vzdy <= n, cinitele se tedy baleji do limbu
+        std::vector<limb_t> factors;
+        limb_t packed = 1;
+        const auto push_factor = [&](limb_t factor) { push_packed_factor(factors, packed, factor); };
+
+        for (std::size_t i = 1; i < primes.size() && primes[i] <= n; ++i) {
+            const uint32_t p = primes[i];
+            if (p > n / 2) {
+                push_factor(p);
+            }
+            else if (p > n / 3) {
+                continue;
+            }
+            else if (static_cast<uint64_t>(p) * p > n) {
+                if ((n / p) & 1) push_factor(p);
+            }
+            else {
+                // Exponent je pocet lichych hodnot n / p^k
+                limb_t power = 1;
+                for (uint32_t q = n / p; q > 0; q /= p) {
+                    if (q & 1) power *= p;
+                }
+                if (power > 1) push_factor(power);
             }
         }
+        if (packed > 1) {
+            factors.push_back(packed);
+        }
+
+        return product_limbs(factors.data(), factors.size());
+    }
+
+    // Pomocna metoda: n! z nejblizsiho nizsiho vychoziho bodu tabulky a nasobeni zbyvajicimi cisly (po dvojicich v limbu)
+    static MpInt factorial_from_table(uint32_t n) {
+        const mp_detail::FactorialTable& table = mp_detail::Factorials;
+        std::size_t entry = n / mp_detail::FactorialTableStep;
+
+        // n! < n^n ma nejvyse n * bit_width(n) bitu, pak se mezivysledky nekontroluji
+        if (fits_bits(static_cast<std::size_t>(n) * static_cast<std::size_t>(std::bit_width(n)))) {
+            MpInt result(table.limbs.begin() + table.offsets[entry], table.limbs.begin() + table.offsets[entry + 1]);
+            for (limb_t i = entry * mp_detail::FactorialTableStep + 1; i <= n; i += 2) {
+                result.template mul_add_limb<false>(i < n ? i * (i + 1) : i, 0);
+            }
+            return result;
+        }
+
+        if constexpr (!is_unlimited) {
+            // Vychozi bod, ktery se nevejde, by skoncil jinou vyjimkou nez preteceni pri nasobeni
+            while (entry > 0 && table.offsets[entry + 1] - table.offsets[entry] > MaxChunks) {
+                --entry;
+            }
+        }
+        MpInt result(table.limbs.begin() + table.offsets[entry], table.limbs.begin() + table.offsets[entry + 1]);
+        for (limb_t i = entry * mp_detail::FactorialTableStep + 1; i <= n; i += 2) {
+            result.mul_add_limb(i < n ? i * (i + 1) : i, 0);
+        }
+        result.ensure_valid_size();
+        return result;
+    }
+
+    // Pomocna metoda: Licha cast n! rekurzi oddFactorial(n) = oddFactorial(n/2)^2 * odd_swing(n)
+    static MpInt odd_factorial(uint32_t n, const std::vector<uint32_t>& primes) {
+        if (n < SmallFactorials.size()) {
+            const int64_t value = SmallFactorials[n];
+            return MpInt(value >> std::countr_zero(static_cast<uint64_t>(value)));
+        }
+
+        // Swing cislo nezavisi na rekurzi, pri vice vlaknech se pocita soubezne
+        MpThreadPool& pool = MpThreadPool::instance();
+        if (pool.thread_count() > 1) {
+            std::future<MpInt> swing = pool.submit([n, &primes] { return odd_swing(n, primes); });
+            const MpInt half_squared = odd_factorial(n / 2, primes).square();
+            return half_squared * pool.wait(swing);
+        }
+        const MpInt half_squared = odd_factorial(n / 2, primes).square();
+        return half_squared * odd_swing(n, primes);
+    }
+
+    // Pomocna metoda: Licha cast C(n, k) pro k <= n - k jako soucin mocnin lichych prvocisel. Exponent p je podle
+    // Kummerovy vety pocet prenosu pri scitani k + (n - k) v soustave o zakladu p, mocnina p je tedy vzdy <= n
+    static MpInt odd_binomial(uint32_t n, uint32_t k) {
+        const std::vector<uint32_t> primes = primes_up_to(n);
+        std::vector<limb_t> factors;
+        limb_t packed = 1;
+        const auto push_factor = [&](limb_t factor) { push_packed_factor(factors, packed, factor); };
+
+        const uint32_t rest = n - k;
+        for (std::size_t i = 1; i < primes.size(); ++i) {
+            const uint32_t p = primes[i];
+            if (p > rest) {
+                // Prvocisla z (n - k, n] deli jen citatel
+                push_factor(p);
+            }
+            else if (static_cast<uint64_t>(p) * p > n) {
+                // Jedna cislice: prenos nastane, prave kdyz n mod p < k mod p
+                if (n % p < k % p) push_factor(p);
+            }
+            else {
+                limb_t power = 1;
+                uint32_t carry = 0;
+                for (uint32_t a = k, b = rest; a > 0 || b > 0 || carry > 0; a /= p, b /= p) {
+                    carry = (a % p + b % p + carry) >= p ? 1 : 0;
+                    if (carry) power *= p;
+                }
+                if (power > 1) push_factor(power);
+            }
+        }
+        if (packed > 1) {
+            factors.push_back(packed);
+        }
+
+        return product_limbs(factors.data(), factors.size());
+    }
+
+    // Pomocna metoda: C(n, k) primo jako n (n - 1) ... (n - k + 1) / k! bez sita prvocisel do n (pro male k)
+    static MpInt direct_binomial(uint32_t n, uint32_t k) {
+        std::vector<limb_t> factors;
+        limb_t packed = 1;
+        for (uint32_t i = 0; i < k; ++i) {
+            push_packed_factor(factors, packed, n - i);
+        }
+        if (packed > 1) {
+            factors.push_back(packed);
+        }
+        return product_limbs(factors.data(), factors.size()) / factorial(k);
+    }
+
+    // Pomocna metoda: Dvojice (F(n), F(n - 1)) zdvojovanim pro n >= 1. Z (F(m), F(m - 1)) plynou dvema ctverci
+    // F(2m + 1) = 4F(m)^2 - F(m - 1)^2 + 2(-1)^m, F(2m - 1) = F(m)^2 + F(m - 1)^2 a F(2m) jako jejich rozdil
+    static void fibonacci_pair(uint32_t n, MpInt& f, MpInt& g) {
+        f = MpInt(1);
+        g = MpInt(0);
+        bool odd = true;
+        for (int bit = std::bit_width(n) - 2; bit >= 0; --bit) {
+            const MpInt f_square = hybridSquare(f);
+            const MpInt g_square = hybridSquare(g);
+
+            // next = F(2m + 1), prev = F(2m - 1)
+            MpInt next = f_square << 2;
+            next -= g_square;
+            if (odd) next.sub_small(2);
+            else next.add_small(2);
+            MpInt prev = f_square;
+            prev += g_square;
+
+            odd = (n >> bit) & 1;
+            if (odd) {
+                g = next - prev;
+                f = std::move(next);
+            }
+            else {
+                f = next - prev;
+                g = std::move(prev);
+            }
+        }
+    }
+
+    // Kofaktory redukce dvojice (a0, b0) na (a, b): a = u0 * a0 + u1 * b0, b = v0 * a0 + v1 * b0
+    struct GcdCofactors final {
+        MpInt u0{ 1 };
+        MpInt u1;
+        MpInt v0;
+        MpInt v1{ 1 };
+
+        bool is_identity() const { return u1.is_zero() && v0.is_zero(); }
+    };
+
+    // Pomocna metoda: Bity absolutni hodnoty od pozice shift jako jedno slovo (vyssi bity se oriznou)
+    uint64_t bits_at(std::size_t shift) const {
+        uint64_t value = 0;
+        std::size_t index = shift / LimbBits;
+        unsigned offset = shift % LimbBits;
+        for (unsigned filled = 0; filled < 64 && index < chunks.size(); ++index) {
+            value |= static_cast<uint64_t>(chunks[index] >> offset) << filled;
+            filled += LimbBits - offset;
+            offset = 0;
+        }
+        return value;
+    }
+
+    // Pomocna metoda: Nasobeni dvojice zleva kofaktory, (x, y) = (s.u0 * x + s.u1 * y, s.v0 * x + s.v1 * y)
+    static void apply_cofactors(const GcdCofactors& step, MpInt& x, MpInt& y) {
+        MpInt next_x = multiply_add(step.u1, y, step.u0 * x);
+        MpInt next_y = multiply_add(step.v1, y, step.v0 * x);
+        x = std::move(next_x);
+        y = std::move(next_y);
+    }
+
+    // Pomocna metoda: Slozeni kofaktoru, po kroku step plati cofactors = step * cofactors
+    static void compose_cofactors(const GcdCofactors& step, GcdCofactors* cofactors) {
+        if (cofactors != nullptr) {
+            apply_cofactors(step, cofactors->u0, cofactors->v0);
+            apply_cofactors(step, cofactors->u1, cofactors->v1);
+        }
+    }
+
+    // Pomocna metoda: Obnoveni a >= b >= 0 po kroku z priblizne hodnoty (radky kofaktoru se upravi stejne)
+    static void normalize_pair(MpInt& a, MpInt& b, GcdCofactors* cofactors) {
+        if (a.is_negative) {
+            a.is_negative = false;
+            if (cofactors != nullptr) {
+                cofactors->u0 = -cofactors->u0;
+                cofactors->u1 = -cofactors->u1;
+            }
+        }
+        if (b.is_negative) {
+            b.is_negative = false;
+            if (cofactors != nullptr) {
+                cofactors->v0 = -cofactors->v0;
+                cofactors->v1 = -cofactors->v1;
+            }
+        }
+        if (compare_abs(a, b) < 0) {
+            std::swap(a, b);
+            if (cofactors != nullptr) {
+                std::swap(cofactors->u0, cofactors->v0);
+                std::swap(cofactors->u1, cofactors->v1);
+            }
+        }
+    }
+
+    // Pomocna metoda: Jeden krok Eukleidova algoritmu (a, b) = (b, a mod b)
+    static void euclid_step(MpInt& a, MpInt& b, GcdCofactors* cofactors) {
+        MpDivModResult<MaxBytes> step = divmod(a, b);
+        a = std::move(b);
+        b = std::move(step.remainder);
+        if (cofactors != nullptr) {
+            // (u, v) = (v, u - q * v)
+            MpInt next_v0 = fused_multiply<true>(step.quotient, cofactors->v0, true, &cofactors->u0, cofactors->u0.is_negative);
+            MpInt next_v1 = fused_multiply<true>(step.quotient, cofactors->v1, true, &cofactors->u1, cofactors->u1.is_negative);
+            cofactors->u0 = std::move(cofactors->v0);
+            cofactors->u1 = std::move(cofactors->v1);
+            cofactors->v0 = std::move(next_v0);
+            cofactors->v1 = std::move(next_v1);
+        }
+    }
+
+    // Pomocna metoda: Linearni kombinace cx * x + cy * y s koeficienty jednoduche presnosti (|c| < 2^(LimbBits - 2))
+    static MpInt combine_small(const MpInt& x, int64_t cx, const MpInt& y, int64_t cy) {
+        MpInt result = x;
+        result.mul_add_limb<false>(static_cast<limb_t>(cx < 0 ? -cx : cx), 0);
+        result.is_negative = x.is_negative != (cx < 0);
+        result.remove_leading_zeros();
+        MpInt other = y;
+        other.mul_add_limb<false>(static_cast<limb_t>(cy < 0 ? -cy : cy), 0);
+        other.remove_leading_zeros();
+        result.add_signed_in_place(other, y.is_negative != (cy < 0) && !other.is_zero());
+        return result;
+    }
+
+    // Pomocna metoda: Kofaktory po Lehmerove kroku, (u, v) = (A u + B v, C u + D v). U Eukleidovy posloupnosti maji
+    // u a v opacna znamenka stejne jako A a B, scitaji se tedy jen absolutni hodnoty v jednom pruchodu
+    static void lehmer_cofactors(MpInt& u, MpInt& v, int64_t A, int64_t B, int64_t C, int64_t D) {
+        if (!u.is_zero() && !v.is_zero() && u.is_negative == v.is_negative) {
+            MpInt next_u = combine_small(u, A, v, B);
+            v = combine_small(u, C, v, D);
+            u = std::move(next_u);
+            return;
+        }
+        const bool u_negative = A != 0 && !u.is_zero() ? (A < 0) != u.is_negative : (B < 0) != v.is_negative;
+        const bool v_negative = C != 0 && !u.is_zero() ? (C < 0) != u.is_negative : (D < 0) != v.is_negative;
+        const std::size_t size = std::max(u.chunks.size(), v.chunks.size());
+        u.chunks.resize(size, 0);
+        v.chunks.resize(size, 0);
+        limb_t u_high, v_high;
+        mp_detail::lehmer_cofactors(u.limbs(), v.limbs(), static_cast<limb_t>(A < 0 ? -A : A), static_cast<limb_t>(B < 0 ? -B : B),
+                                    static_cast<limb_t>(C < 0 ? -C : C), static_cast<limb_t>(D < 0 ? -D : D), u_high, v_high);
+        u.chunks.push_back(u_high);
+        v.chunks.push_back(v_high);
+        u.is_negative = u_negative;
+        v.is_negative = v_negative;
+        u.remove_leading_zeros();
+        v.remove_leading_zeros();
+    }
+
+    // Pomocna metoda: Lehmeruv krok (a >= b > 0): podily z nejvyssich LimbBits - 2 bitu v jednoduche presnosti,
+    // kofaktory se pak pouziji na cela cisla naraz. Bez jedineho jisteho podilu jeden krok deleni
+    static void lehmer_step(MpInt& a, MpInt& b, GcdCofactors* cofactors) {
+        constexpr std::size_t LehmerBits = LimbBits - 2;
+        const std::size_t bits = a.bit_length();
+        const std::size_t shift = bits > LehmerBits ? bits - LehmerBits : 0;
+        int64_t x = static_cast<int64_t>(a.bits_at(shift));
+        int64_t y = static_cast<int64_t>(b.bits_at(shift));
+        int64_t A = 1, B = 0, C = 0, D = 1;
+
+        // Knuth, algoritmus L: podil se prijme, jen kdyz je stejny pro obe meze skutecneho pomeru
+        while (y != 0 && y + C > 0 && y + D > 0) {
+            const int64_t q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D)) {
+                break;
+            }
+            int64_t t = A - q * C;
+            A = C;
+            C = t;
+            t = B - q * D;
+            B = D;
+            D = t;
+            t = x - q * y;
+            x = y;
+            y = t;
+        }
+
+        if (B == 0) {
+            euclid_step(a, b, cofactors);
+            return;
+        }
+        // Po sudem poctu kroku je B < 0, znamenka koeficientu se stridaji
+        b.chunks.resize(a.chunks.size(), 0);
+        mp_detail::lehmer_update(a.limbs(), b.limbs(), static_cast<limb_t>(A < 0 ? -A : A), static_cast<limb_t>(B < 0 ? -B : B),
+                                 static_cast<limb_t>(C < 0 ? -C : C), static_cast<limb_t>(D < 0 ? -D : D), B < 0);
+        a.remove_leading_zeros();
+        b.remove_leading_zeros();
+        if (cofactors != nullptr) {
+            lehmer_cofactors(cofactors->u0, cofactors->v0, A, B, C, D);
+            lehmer_cofactors(cofactors->u1, cofactors->v1, A, B, C, D);
+        }
+        normalize_pair(a, b, cofactors);
+    }
+
+    // Pomocna metoda: Redukce (a, b) kofaktory polovicniho GCD jejich bitu od pozice shift vyse
+    // (kofaktory hornich casti plati i pro cela cisla, odchylku opravi normalize_pair)
+    static void reduce_by_top(MpInt& a, MpInt& b, std::size_t shift, GcdCofactors* cofactors) {
+        MpInt high_a = a >> static_cast<uint32_t>(shift);
+        MpInt high_b = b >> static_cast<uint32_t>(shift);
+        const GcdCofactors step = half_gcd(high_a, high_b);
+        if (step.is_identity()) {
+            // Horni casti se nedaji redukovat (b je mnohem mensi nez a)
+            euclid_step(a, b, cofactors);
+            return;
+        }
+        apply_cofactors(step, a, b);
+        compose_cofactors(step, cofactors);
+        normalize_pair(a, b, cofactors);
+    }
+
+    // Pomocna metoda: Polovicni GCD: redukce (a, b), a >= b >= 0, dokud b nema nejvyse polovinu bitu puvodniho a.
+    // Velka cisla rekurzivne: horni polovina je zmensi zhruba na tri ctvrtiny, druha rekurze nad hornimi
+    // 2 * (bity - cil) bity dovede b k cili. Vraci kofaktory cele redukce
+    static GcdCofactors half_gcd(MpInt& a, MpInt& b) {
+        GcdCofactors cofactors;
+        const std::size_t target = a.bit_length() / 2 + 1;
+        if (b.bit_length() <= target) {
+            return cofactors;
+        }
+
+        const std::size_t recursive_bits = HGCD_THRESHOLD * LimbBits;
+        if (a.bit_length() >= 2 * recursive_bits) {
+            reduce_by_top(a, b, a.bit_length() / 2, &cofactors);
+        }
+        while (b.bit_length() > target) {
+            const std::size_t bits = a.bit_length();
+            const std::size_t shift = std::max(2 * target > bits ? 2 * target - bits : 0, bits / 4);
+            if (bits - shift >= recursive_bits) {
+                reduce_by_top(a, b, shift, &cofactors);
+            }
+            else {
+                lehmer_step(a, b, &cofactors);
+            }
+        }
+        return cofactors;
+    }
+
+    // Pomocna metoda: Eukleidova redukce (a, b), a >= b >= 0, az do b = 0 (v a zustane gcd), volitelne s kofaktory
+    static void gcd_reduce(MpInt& a, MpInt& b, GcdCofactors* cofactors) {
+        while (!b.is_zero()) {
+            if (b.chunks.size() >= GCD_THRESHOLD && a.chunks.size() < 2 * b.chunks.size()) {
+                // Polovicni GCD celych cisel je zmensi zhruba na polovinu
+                const GcdCofactors step = half_gcd(a, b);
+                if (step.is_identity()) {
+                    euclid_step(a, b, cofactors);
+                }
+                else {
+                    compose_cofactors(step, cofactors);
+                }
+            }
+            else if (cofactors == nullptr && a.chunks.size() == 1) {
+                a.chunks[0] = std::gcd(a.chunks[0], b.chunks[0]);
+                b = MpInt();
+            }
+            else {
+                lehmer_step(a, b, cofactors);
+            }
+        }
+    }
+
+    // Pomocna metoda: Odhad log2 absolutni hodnoty z nejvyssich 64 bitu
+    double log2_estimate() const {
+        const std::size_t bits = bit_length();
+        const std::size_t shift = bits > 64 ? bits - 64 : 0;
+        return std::log2(static_cast<double>(bits_at(shift))) + static_cast<double>(shift);
+    }
+
+    // Pomocna metoda: Pocet nulovych bitu na konci (pro nenulovou hodnotu)
+    std::size_t trailing_zero_bits() const {
+        std::size_t index = 0;
+        while (chunks[index] == 0) {
+            ++index;
+        }
+        return index * LimbBits + static_cast<std::size_t>(std::countr_zero(chunks[index]));
+    }
+
+    // Pomocna metoda: floor(n^(1/k)) pro n >= 0, exact oznaci presnou mocninu. Newtonova iterace se zdvojovanim
+    // presnosti: odmocnina hornich bitu (rekurzivne) dava odhad shora s polovicni presnosti, jeden krok
+    // x = ((k - 1) x + n / x^(k - 1)) / k ji zdvoji a zbyle korekce o jednicku potvrdi jedno umocneni
+    static MpInt root_abs(const MpInt& n, uint32_t k, bool& exact) {
+        const std::size_t bits = n.bit_length();
+        if (k == 1 || n.compare_small(1) <= 0) {
+            exact = true;
+            return n;
+        }
+        if (k >= bits) {
+            // 1 < n < 2^k
+            exact = false;
+            return MpInt(1);
+        }
+
+        const std::size_t root_bits = bits / k;
+        MpInt root;
+        MpInt power;
+        if (root_bits <= 48) {
+            // Odhad z logaritmu nejvyssich bitu v plovouci carce, presny na vic nez 48 bitu (korekce obema smery)
+            root = MpInt(static_cast<int64_t>(std::exp2(n.log2_estimate() / k)));
+            power = pow(root, k);
+            while (compare_abs(power, n) > 0) {
+                root.sub_small(1);
+                power = pow(root, k);
+            }
+            for (MpInt next = root + 1, next_power = pow(next, k); compare_abs(next_power, n) <= 0; next_power = pow(next, k)) {
+                root = next;
+                power = std::move(next_power);
+                next.add_small(1);
+            }
+            exact = compare_abs(power, n) == 0;
+            return root;
+        }
+
+        // Horni bity n >> (k * shift) maji odmocninu s polovicnim poctem bitu, +1 ji posune nad skutecnou hodnotu.
+        // Chyba po kroku je nejvyse (k - 1) / 2 * 2^(2 shift) / x < 1
+        const std::size_t shift = (root_bits - 1 - std::bit_width(k)) / 2;
+        bool seed_exact;
+        MpInt seed = root_abs(n >> static_cast<uint32_t>(k * shift), k, seed_exact);
+        seed.add_small(1);
+        seed.leftShift(static_cast<uint32_t>(shift));
+
+        root = seed;
+        root.mul_small(k - 1);
+        root += n / pow(seed, k - 1);
+        root.divmod_small(k);
+
+        // Newtonuv krok shora neklesne pod floor(n^(1/k))
+        power = pow(root, k);
+        while (compare_abs(power, n) > 0) {
+            root.sub_small(1);
+            power = pow(root, k);
+        }
+        exact = compare_abs(power, n) == 0;
+        return root;
+    }
+
+    // Pomocna metoda: Levne vylouceni p-te mocniny (false = n > 1 urcite neni p-ta mocnina). Pro odmocninu do 32 bitu
+    // se odhad z plovouci carky porovna v dolnich 64 bitech, jinak Eulerovo kriterium modulo prvocisel q = 2jp + 1
+    static bool may_be_power(const MpInt& n, uint32_t p) {
+        const auto pow_wrap = [](uint64_t base, uint64_t exponent, uint64_t mod) {
+            uint64_t result = 1;
+            for (; exponent > 0; exponent >>= 1) {
+                if (exponent & 1) {
+                    result = mod == 0 ? result * base : result * base % mod;
+                }
+                base = mod == 0 ? base * base : base * base % mod;
+            }
+            return result;
+        };
+
+        if (n.bit_length() / p <= 32) {
+            const uint64_t estimate = static_cast<uint64_t>(std::exp2(n.log2_estimate() / p));
+            const uint64_t low = n.bits_at(0);
+            for (uint64_t root = estimate > 0 ? estimate - 1 : 0; root <= estimate + 1; ++root) {
+                if (pow_wrap(root, p, 0) == low) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const auto is_prime = [](uint64_t q) {
+            for (uint64_t d = 3; d * d <= q; d += 2) {
+                if (q % d == 0) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        int tests = 0;
+        for (uint64_t q = 2 * static_cast<uint64_t>(p) + 1; q < (uint64_t(1) << 32) && tests < 4; q += 2 * p) {
+            if (!is_prime(q)) {
+                continue;
+            }
+            const uint32_t residue = mp_detail::mod_1(n.limbs(), static_cast<uint32_t>(q));
+            if (residue != 0) {
+                if (pow_wrap(residue, (q - 1) / p, q) != 1) {
+                    return false;
+                }
+                ++tests;
+            }
+        }
+        return true;
+    }
+
+    // Pomocna metoda: Nezaporna hodnota z 64bitoveho slova (i mimo rozsah int64_t)
+    static MpInt from_word(uint64_t value) {
+        std::array<limb_t, 64 / LimbBits> parts{};
+        for (std::size_t i = 0; i < parts.size(); ++i) {
+            parts[i] = static_cast<limb_t>(value >> (i * LimbBits));
+        }
+        return MpInt(parts.begin(), parts.end());
+    }
+
+    // Pomocna metoda: Nejnizsich bits bitu nezaporne hodnoty (x mod 2^bits)
+    static MpInt low_bits(MpInt x, std::size_t bits) {
+        const std::size_t count = (bits + LimbBits - 1) / LimbBits;
+        if (x.chunks.size() >= count) {
+            x.chunks.resize(count);
+            if (bits % LimbBits != 0) {
+                x.chunks.back() &= (limb_t(1) << (bits % LimbBits)) - 1;
+            }
+            x.remove_leading_zeros();
+        }
+        return x;
+    }
+
+    // Pomocna metoda: base^exponent mod 2^bits (binarni umocnovani s orezavanim mezivysledku)
+    static MpInt pow_low(const MpInt& base, uint32_t exponent, std::size_t bits) {
+        MpInt result(1);
+        for (uint32_t mask = std::bit_floor(exponent); mask > 0; mask >>= 1) {
+            result = low_bits(result.square(), bits);
+            if (exponent & mask) {
+                result = low_bits(result * base, bits);
+            }
+        }
+        return result;
+    }
+
+    // Pomocna metoda: Jedina 2-adicka p-ta odmocnina licheho n pro liche p, tj. r < 2^bits s r^p = n mod 2^bits
+    // (je-li n = m^p a m < 2^bits, pak m = r). Newtonova iterace pro y = n^(-1/p): y = y - y (n y^p - 1) / p
+    // zdvojuje pocet platnych bitu, prvnich 64 bitu se pocita nativne a nakonec r = n y^(p - 1)
+    static MpInt odd_root_2adic(const MpInt& n, uint32_t p, std::size_t bits) {
+        const auto pow_wrap = [](uint64_t base, uint32_t exponent) {
+            uint64_t result = 1;
+            for (; exponent > 0; exponent >>= 1) {
+                if (exponent & 1) {
+                    result *= base;
+                }
+                base *= base;
+            }
+            return result;
+        };
+
+        const uint64_t low = n.bits_at(0);
+        uint64_t p_inverse = p;
+        for (unsigned valid = 3; valid < 64; valid *= 2) {
+            p_inverse *= 2 - p * p_inverse;
+        }
+        uint64_t y = 1;
+        for (unsigned valid = 1; valid < 64; valid *= 2) {
+            y -= y * (low * pow_wrap(y, p) - 1) * p_inverse;
+        }
+        if (bits <= 64) {
+            const uint64_t root = low * pow_wrap(y, p - 1);
+            return from_word(bits == 64 ? root : root & ((uint64_t(1) << bits) - 1));
+        }
+
+        MpInt inverse_root = from_word(y);
+        for (std::size_t valid = 64; valid < bits;) {
+            valid = std::min(2 * valid, bits);
+            // Chyba n y^p - 1 je delitelna 2^(puvodni presnost), deleni p modulo 2^valid je Hensel deleni
+            MpInt error = low_bits(low_bits(n, valid) * pow_low(inverse_root, p, valid), valid);
+            error.sub_small(1);
+            error.chunks.resize((valid + LimbBits - 1) / LimbBits, 0);
+            mp_detail::bdiv_q_1(error.limbs(), error.limbs(), p);
+            error.remove_leading_zeros();
+
+            inverse_root -= low_bits(inverse_root * low_bits(error, valid), valid);
+            if (inverse_root.is_negative) {
+                inverse_root += MpInt(1) << static_cast<uint32_t>(valid);
+            }
+        }
+        return low_bits(low_bits(n, bits) * pow_low(inverse_root, p - 1, bits), bits);
+    }
+
+    // Pomocna metoda: Zda je liche n > 1 p-tou mocninou. Liche ctverce jsou 1 mod 8 a projdou levnym testem may_be_power,
+    // pro liche p je jedinym kandidatem 2-adicka odmocnina s bits / p + 1 bity (cena ~ M(bits / p)),
+    // kterou odhad log2 skoro vzdy vylouci bez umocneni na plnou delku. U dlouhych odmocnin je levnejsi
+    // nejdriv Eulerovo kriterium z may_be_power (nekolik linearnich pruchodu n)
+    static bool is_odd_power(const MpInt& n, uint32_t p) {
+        if (p == 2) {
+            bool exact = false;
+            if ((n.chunks[0] & 7) == 1 && may_be_power(n, 2)) {
+                root_abs(n, 2, exact);
+            }
+            return exact;
+        }
+
+        const std::size_t bits = n.bit_length();
+        if (bits / p > POWER_RESIDUE_THRESHOLD && !may_be_power(n, p)) {
+            return false;
+        }
+        const MpInt root = odd_root_2adic(n, p, bits / p + 1);
+        if (std::abs(p * root.log2_estimate() - n.log2_estimate()) > 1e-9 * static_cast<double>(bits)) {
+            return false;
+        }
+        return compare_abs(pow(root, p), n) == 0;
+    }
+
+    // Pomocna metoda: Kopie hodnoty v sirsim typu (mezivysledek pro rezimy preteceni a operace ruznych presnosti)
+    template <std::size_t WideBytes>
+    static constexpr MpInt<WideBytes> widen(const MpInt& x) {
+        MpInt<WideBytes> wide(x.chunks.begin(), x.chunks.end());
+        wide.is_negative = x.is_negative;
+        return wide;
+    }
+
+    // Pomocna metoda: Zuzeni vysledku ze sirsiho typu podle rezimu preteceni
+    // (vyjimka v rezimu Throw nese nejnizsich MaxBits bitu jako v rezimu Wrap)
+    template <std::size_t WideBytes>
+    static MpInt narrow(const MpInt<WideBytes>& wide, MpOverflowMode mode) {
+        const bool overflow = wide.bit_length() > MaxBits;
+
+        MpInt result;
+        if (!overflow) {
+            result = MpInt(wide.chunks.begin(), wide.chunks.end());
+        }
+        else {
+            if (mode == MpOverflowMode::Saturate) {
+                result.chunks.assign(MaxChunks, ~limb_t(0));
+            }
+            else {
+                result = MpInt(wide.chunks.begin(), wide.chunks.begin() + MaxChunks);
+            }
+            // Nejvyssi chunk muze byt vyuzit jen castecne
+            if constexpr (MaxBits % LimbBits != 0) {
+                if (result.chunks.size() == MaxChunks) {
+                    result.chunks.back() &= (limb_t(1) << (MaxBits % LimbBits)) - 1;
+                }
+            }
+        }
+        result.is_negative = wide.is_negative;
+        result.remove_leading_zeros();
+        if (overflow && mode == MpOverflowMode::Throw) {
+            throw MpIntOverflowException<MaxBytes>("Preteceni", result);
+        }
+        return result;
+    }
+
+public:
+    static constexpr std::size_t Unlimited = std::numeric_limits<std::size_t>::max();
+
+    // Zakladni konstruktor
+    constexpr MpInt() : chunks(1, 0), is_negative(false) {}
+
+    // Konstruktor z celociselne hodnoty
+    constexpr explicit MpInt(int64_t value) {
+        is_negative = value < 0;
+        const uint64_t abs_value = is_negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+
+        // Rozdeleni hodnoty na chunky (pri 64bitovych limbech staci jeden)
+        constexpr unsigned chunks_per_value = (64 + LimbBits - 1) / LimbBits;
+        for (unsigned i = 0; i < chunks_per_value; ++i) {
+            chunks.push_back(static_cast<limb_t>(abs_value >> (i * LimbBits)));
+        }
+        remove_leading_zeros();
+    }
+
+    // Konstruktor z iteratoru
+    template <std::input_iterator InputIt>
+    constexpr MpInt(InputIt first, InputIt last) : is_negative(false) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            chunks.reserve(static_cast<std::size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            if (chunks.size() == MaxChunks) {
+                throw MpIntOverflowException<MaxBytes>("Prekrocen maximalni pocet chunku", *this);
+            }
+            chunks.push_back(*first);
+        }
+        if (chunks.empty()) {
+            chunks.push_back(0);
+        }
+        remove_leading_zeros();
+    }
+
+    // Kopirovaci konstruktor
+    constexpr MpInt(const MpInt& other) = default;
+
+    // Presunovaci konstruktor
+    constexpr MpInt(MpInt&& other) noexcept = default;
+
+    // Kopirovaci operator prirazeni
+    constexpr MpInt& operator=(const MpInt& other) = default;
+
+    // Presunovaci operator prirazeni
+    constexpr MpInt& operator=(MpInt&& other) noexcept = default;
+
+    // Operator scitani (pri jine presnosti ma vysledek sirsi z obou typu)
+    template <std::size_t OtherMaxBytes>
+    constexpr MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> operator+(const MpInt<OtherMaxBytes>& other) const {
+        if constexpr (OtherMaxBytes == MaxBytes) {
+            return signed_add(*this, other, other.is_negative);
+        }
+        else {
+            constexpr std::size_t ResultBytes = MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes;
+            return widen<ResultBytes>(*this) + MpInt<OtherMaxBytes>::template widen<ResultBytes>(other);
+        }
+    }
+
+    // Operator scitani s int
+    constexpr MpInt operator+(int value) const {
+        MpInt result = *this;
+        result += value;
+        return result;
+    }
+
+    // Operator odcitani (pri jine presnosti ma vysledek sirsi z obou typu)
+    template <std::size_t OtherMaxBytes>
+    constexpr MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> operator-(const MpInt<OtherMaxBytes>& other) const {
+        if constexpr (OtherMaxBytes == MaxBytes) {
+            return signed_add(*this, other, !other.is_negative);
+        }
+        else {
+            constexpr std::size_t ResultBytes = MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes;
+            return widen<ResultBytes>(*this) - MpInt<OtherMaxBytes>::template widen<ResultBytes>(other);
+        }
+    }
+
+    // Naivni nasobeni pro male vstupy
+    constexpr MpInt naiveMultiply(const MpInt& other) const {
+        MpInt result;
+        result.chunks.resize(chunks.size() + other.chunks.size());
+        mp_detail::mul_basecase({ result.chunks.data(), result.chunks.size() }, limbs(), other.limbs());
+
+        if (result.chunks.empty()) {
+            result.chunks.push_back(0);
+        }
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
+    }
+
+    // Optimalizovane Karatsubovo nasobeni (jedna alokace pomocne pameti na cele volani)
+    template <std::size_t OtherMaxBytes>
+    MpInt karatsubaMultiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
+        MpInt result;
+        result.chunks.resize(x.chunks.size() + y.chunks.size());
+        const std::span<limb_t> result_limbs(result.chunks.data(), result.chunks.size());
+        if (MpThreadPool::instance().thread_count() > 1) {
+            karatsuba_parallel(result_limbs, x.limbs(), y.limbs(), KARATSUBA_PARALLEL_DEPTH);
+        }
+        else {
+            std::vector<limb_t> scratch(karatsuba_scratch_size(std::max(x.chunks.size(), y.chunks.size())));
+            karatsuba_limbs(result_limbs, x.limbs(), y.limbs(), scratch);
+        }
+
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
+    }
+
+    // Toom-Cook 3: tri casti, vyhodnoceni v bodech 0, 1, -1, 2, nekonecno
+    template <std::size_t OtherMaxBytes>
+    MpInt toom3Multiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
+        const std::size_t n = std::max(x.chunks.size(), y.chunks.size());
+        const std::size_t part_size = (n + 2) / 3;
+
+        const std::vector<MpInt> a = split_limbs(x, 3, part_size);
+        const std::vector<MpInt> b = split_limbs(y, 3, part_size);
+
+        // Soucin v jednotlivych bodech (operandy mohou byt zaporne)
+        const MpInt r0 = a[0] * b[0];
+        const MpInt r1 = evaluate_at(a, 1) * evaluate_at(b, 1);
+        const MpInt r_m1 = evaluate_at(a, -1) * evaluate_at(b, -1);
+        const MpInt r2 = evaluate_at(a, 2) * evaluate_at(b, 2);
+        const MpInt r_inf = a[2] * b[2];
+
+        // Interpolace koeficientu c0..c4 presnymi delenimi
+        const MpInt even = divide_exact(r1 + r_m1, 2);                               // c0 + c2 + c4
+        const MpInt odd = divide_exact(r1 - r_m1, 2);                                // c1 + c3
+        const MpInt c2 = even - r0 - r_inf;
+        const MpInt t = divide_exact(r2 - r0 - (c2 << 2) - (r_inf << 4), 2);         // c1 + 4c3
+        const MpInt c3 = divide_exact(t - odd, 3);
+        const MpInt c1 = odd - c3;
+
+        return combine_parts({ r0, c1, c2, c3, r_inf }, part_size);
+    }
+
+    // Toom-Cook 4: ctyri casti, vyhodnoceni v bodech 0, 1, -1, 2, -2, 3, nekonecno
+    template <std::size_t OtherMaxBytes>
+    MpInt toom4Multiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
+        const std::size_t n = std::max(x.chunks.size(), y.chunks.size());
+        const std::size_t part_size = (n + 3) / 4;
+
+        const std::vector<MpInt> a = split_limbs(x, 4, part_size);
+        const std::vector<MpInt> b = split_limbs(y, 4, part_size);
+
+        const MpInt r0 = a[0] * b[0];
+        const MpInt r1 = evaluate_at(a, 1) * evaluate_at(b, 1);
+        const MpInt r_m1 = evaluate_at(a, -1) * evaluate_at(b, -1);
+        const MpInt r2 = evaluate_at(a, 2) * evaluate_at(b, 2);
+        const MpInt r_m2 = evaluate_at(a, -2) * evaluate_at(b, -2);
+        const MpInt r3 = evaluate_at(a, 3) * evaluate_at(b, 3);
+        const MpInt r_inf = a[3] * b[3];
+
+        // Sude koeficienty z bodu +-1 a +-2
+        const MpInt even1 = divide_exact(r1 + r_m1, 2) - r0 - r_inf;                 // c2 + c4
+        const MpInt even2 = divide_exact(r2 + r_m2, 2) - r0 - (r_inf << 6);          // 4c2 + 16c4
+        const MpInt c4 = divide_exact(even2 - (even1 << 2), 12);
+        const MpInt c2 = even1 - c4;
+
+        // Liche koeficienty z bodu +-1, +-2 a 3
+        const MpInt odd1 = divide_exact(r1 - r_m1, 2);                               // c1 + c3 + c5
+        const MpInt odd2 = divide_exact(r2 - r_m2, 4);                               // c1 + 4c3 + 16c5
+        const MpInt odd3 = divide_exact(r3 - r0 - MpInt(c2).mul_small(9) - MpInt(c4).mul_small(81) - MpInt(r_inf).mul_small(729), 3); // c1 + 9c3 + 81c5
+        const MpInt d1 = divide_exact(odd2 - odd1, 3);                               // c3 + 5c5
+        const MpInt d2 = divide_exact(odd3 - odd2, 5);                               // c3 + 13c5
+        const MpInt c5 = divide_exact(d2 - d1, 8);
+        const MpInt c3 = d1 - MpInt(c5).mul_small(5);
+        const MpInt c1 = odd1 - c3 - c5;
+
+        return combine_parts({ r0, c1, c2, c3, c4, c5, r_inf }, part_size);
+    }
+
+    // Nasobeni cislo-teoretickou transformaci pro velmi velka cisla
+    template <std::size_t OtherMaxBytes>
+    MpInt nttMultiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
+        MpInt result;
+        result.chunks.resize(x.chunks.size() + y.chunks.size());
+        mp_detail::ntt_multiply(x.chunks.data(), x.chunks.size(), y.chunks.data(), y.chunks.size(), result.chunks.data());
+        result.remove_leading_zeros();
+        result.ensure_valid_size();
+        return result;
+    }
+
+    // Hybridni logika nasobeni
+    template <std::size_t OtherMaxBytes>
+    MpInt hybridMultiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
+        const std::size_t x_size = x.chunks.size();
+        const std::size_t y_size = y.chunks.size();
+        const std::size_t min_size = std::min(x_size, y_size);
+
+        if (min_size < NAIVE_THRESHOLD) {
+            return x.naiveMultiply(y);
+        }
+
+        if (min_size >= NTT_THRESHOLD && x_size + y_size <= mp_detail::NttMaxLimbs) {
+            return nttMultiply(x, y);
+        }
+
+        // Vyrazne nevyvazene operandy pro Toom (nebo nad limitem NTT): delsi se krajeji na useky delky kratsiho
+        if (min_size >= KARATSUBA_THRESHOLD && std::max(x_size, y_size) >= UNBALANCED_RATIO * min_size) {
+            return x_size >= y_size ? multiply_unbalanced(x, y) : multiply_unbalanced(y, x);
+        }
+
+        if (min_size < KARATSUBA_THRESHOLD) {
+            return karatsubaMultiply(x, y);
+        }
+
+        if (min_size < TOOM4_THRESHOLD) {
+            return toom3Multiply(x, y);
+        }
+
+        return toom4Multiply(x, y);
+    }
+
+    // Hybridni logika umocneni na druhou (absolutni hodnota), urovne odpovidaji hybridMultiply
+    static MpInt hybridSquare(const MpInt& x) {
+        const std::size_t size = x.chunks.size();
+        MpInt result;
+
+        if (size >= NTT_THRESHOLD && 2 * size <= mp_detail::NttMaxLimbs) {
+            return result.nttMultiply(x, x);
+        }
+        if (size >= KARATSUBA_THRESHOLD) {
+            return size < TOOM4_THRESHOLD ? result.toom3Multiply(x, x) : result.toom4Multiply(x, x);
+        }
+
+        result.chunks.resize(2 * size);
+        const std::span<limb_t> result_limbs(result.chunks.data(), result.chunks.size());
+        if (size < SQUARE_NAIVE_THRESHOLD) {
+            mp_detail::sqr_basecase(result_limbs, x.limbs());
+        }
+        else if (MpThreadPool::instance().thread_count() > 1) {
+            karatsuba_parallel(result_limbs, x.limbs(), x.limbs(), KARATSUBA_PARALLEL_DEPTH);
+        }
+        else {
+            std::vector<limb_t> scratch(karatsuba_scratch_size(size));
+            karatsuba_square_limbs(result_limbs, x.limbs(), scratch);
+        }
 
         result.remove_leading_zeros();
         result.ensure_valid_size();
         return result;
     }
 
-    // Optimalizovane Karatsubovo nasobeni
-    template <std::size_t OtherMaxBytes>
-    MpInt karatsubaMultiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
-        const std::size_t n = std::max(x.chunks.size(), y.chunks.size());
+    // Umocneni na druhou
+    MpInt square() const {
+        return hybridSquare(*this);
+    }
 
-        // Zakladni pripad: pouziti naivniho nasobeni pro mala cisla
-        if (n <= 2) {
-            return x.naiveMultiply(y);
+    // Umocneni na prirozeny exponent binarnim umocnovanim (mocnina dvojky v zakladu se resi posunem)
+    static MpInt pow(const MpInt& base, uint32_t exponent) {
+        if (exponent == 0) {
+            return MpInt(1);
+        }
+        if (base.is_zero()) {
+            return MpInt();
         }
 
-        const std::size_t half = (n + 1) / 2;
+        if constexpr (!is_unlimited) {
+            // base^e ma vice nez e * log2|base| bitu (logaritmus z nejvyssiho chunku, s rezervou na zaokrouhleni)
+            const double log_base = std::log2(static_cast<double>(base.chunks.back())) + static_cast<double>((base.chunks.size() - 1) * LimbBits);
+            const double lower_bits = exponent * log_base * (1.0 - 1e-9);
+            if (lower_bits > MaxBits + 1.0) {
+                check_predicted_bits(static_cast<std::size_t>(lower_bits));
+            }
+        }
 
-        MpInt x_low(x.chunks.begin(), x.chunks.begin() + std::min(half, x.chunks.size()));
-        MpInt x_high(x.chunks.begin() + std::min(half, x.chunks.size()), x.chunks.end());
-        MpInt y_low(y.chunks.begin(), y.chunks.begin() + std::min(half, y.chunks.size()));
-        MpInt y_high(y.chunks.begin() + std::min(half, y.chunks.size()), y.chunks.end());
+        // base = odd * 2^twos, licha cast se umocni a dvojky se doplni jednim posunem
+        std::size_t zero_chunks = 0;
+        while (base.chunks[zero_chunks] == 0) {
+            ++zero_chunks;
+        }
+        const uint64_t twos = zero_chunks * LimbBits + static_cast<uint64_t>(std::countr_zero(base.chunks[zero_chunks]));
+        if (twos * exponent > std::numeric_limits<uint32_t>::max()) {
+            throw std::overflow_error("Mocnina je prilis velka");
+        }
 
-        // Rekurzivni vypocet tri produktu
-        const MpInt z0 = karatsubaMultiply(x_low, y_low);
-        const MpInt z2 = karatsubaMultiply(x_high, y_high);
-        const MpInt z1 = karatsubaMultiply(x_low + x_high, y_low + y_high) - z2 - z0;
+        MpInt odd = base >> static_cast<uint32_t>(twos);
+        odd.is_negative = false;
+        MpInt result = odd;
+        for (int bit = std::bit_width(exponent) - 2; bit >= 0; --bit) {
+            result = hybridSquare(result);
+            if ((exponent >> bit) & 1) {
+                result *= odd;
+            }
+        }
 
-        // Kombinace vysledku
-        MpInt result = z0 + (z1 << (half * 32)) + (z2 << (2 * half * 32));
-        result.ensure_valid_size();
+        result.leftShift(static_cast<uint32_t>(twos * exponent));
+        result.is_negative = base.is_negative && (exponent & 1);
         return result;
     }
 
-    // Hybridni logika nasobeni
-    template <std::size_t OtherMaxBytes>
-    MpInt hybridMultiply(const MpInt<OtherMaxBytes>& x, const MpInt<OtherMaxBytes>& y) const {
-        // Prahove hodnoty pro prepinani algoritmu
-        constexpr std::size_t NAIVE_THRESHOLD = 16;  // Naivni pro mala cisla
-        constexpr std::size_t KARATSUBA_THRESHOLD = 128; // Karatsuba pro stredni cisla
-
-        const std::size_t x_size = x.chunks.size();
-        const std::size_t y_size = y.chunks.size();
-
-        if (x_size < NAIVE_THRESHOLD || y_size < NAIVE_THRESHOLD) {
-            return x.naiveMultiply(y);
+    // Soucet s volbou chovani pri preteceni (Saturate a Wrap nevyhazuji, vhodne pro smycky s pevnou sirkou)
+    static MpInt add(const MpInt& a, const MpInt& b, MpOverflowMode mode) {
+        if constexpr (is_unlimited) {
+            return a + b;
+        }
+        else {
+            if (mode == MpOverflowMode::Throw) {
+                return a + b;
+            }
+            // Soucet ma nejvyse MaxBits + 1 bitu, vypocet bez kontroly v sirsim typu
+            return narrow(widen<MaxBytes + 8>(a) + widen<MaxBytes + 8>(b), mode);
         }
+    }
 
-        if (x_size < KARATSUBA_THRESHOLD || y_size < KARATSUBA_THRESHOLD) {
-            return karatsubaMultiply(x, y);
+    // Rozdil s volbou chovani pri preteceni
+    static MpInt sub(const MpInt& a, const MpInt& b, MpOverflowMode mode) {
+        if constexpr (is_unlimited) {
+            return a - b;
+        }
+        else {
+            if (mode == MpOverflowMode::Throw) {
+                return a - b;
+            }
+            return narrow(widen<MaxBytes + 8>(a) - widen<MaxBytes + 8>(b), mode);
         }
+    }
 
-        // Zaloha na Karatsubu pro velka cisla
-        return karatsubaMultiply(x, y);
+    // Soucin s volbou chovani pri preteceni
+    static MpInt mul(const MpInt& a, const MpInt& b, MpOverflowMode mode) {
+        if constexpr (is_unlimited) {
+            return a * b;
+        }
+        else {
+            if (mode == MpOverflowMode::Throw) {
+                return a * b;
+            }
+            // Soucin ma nejvyse 2 * MaxBits bitu
+            return narrow(MpInt<2 * MaxBytes + 8>(widen<2 * MaxBytes + 8>(a) * widen<2 * MaxBytes + 8>(b)), mode);
+        }
     }
 
     // Operator nasobeni
-    template <std::size_t OtherMaxBytes>
-    MpInt operator*(const MpInt<OtherMaxBytes>& other) const {
-        MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> result = hybridMultiply(*this, other);
-        result.is_negative = (is_negative != other.is_negative);
-        result.ensure_valid_size();
-        return result;
+    constexpr MpInt operator*(const MpInt& other) const {
+        return fused_multiply<false>(*this, other, false, nullptr, false);
     }
 
-    // Operator deleni
-    template <std::size_t OtherMaxBytes>
-    MpInt operator/(const MpInt<OtherMaxBytes>& other) const {
-        if (other == MpInt(0)) {
+    // Operator nasobeni s jinou presnosti (vysledek ma sirsi z obou typu)
+    template <std::size_t OtherMaxBytes> requires (OtherMaxBytes != MaxBytes)
+    constexpr MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> operator*(const MpInt<OtherMaxBytes>& other) const {
+        constexpr std::size_t ResultBytes = MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes;
+        return widen<ResultBytes>(*this) * MpInt<OtherMaxBytes>::template widen<ResultBytes>(other);
+    }
+
+    // Spojene nasobeni a pricteni: a * b + c do jednoho vysledku bez mezivysledku soucinu
+    static constexpr MpInt multiply_add(const MpInt& a, const MpInt& b, const MpInt& c) {
+        return fused_multiply<true>(a, b, false, &c, c.is_negative);
+    }
+
+    // Deleni se zbytkem v jednom pruchodu: podil se zaokrouhluje k nule, zbytek ma znamenko delence
+    static MpDivModResult<MaxBytes> divmod(const MpInt& dividend, const MpInt& divisor) {
+        if (divisor.is_zero()) {
             throw std::invalid_argument("Deleni nulou.");
         }
 
-        // Osetreni deleni 1 nebo -1
-        if (other.chunks.size() == 1 && other.chunks[0] == 1) {
-            MpInt<(MaxBytes > OtherMaxBytes ? MaxBytes : OtherMaxBytes)> result = *this;
-            result.is_negative = (is_negative != other.is_negative);
+        MpDivModResult<MaxBytes> result;
+        if (compare_abs(dividend, divisor) < 0) {
+            result.remainder = dividend;
             return result;
         }
 
-        if (compare_abs(*this, other) < 0) {
-            return MpInt(0);
-        }
-
-        MpInt quotient;
-        MpInt remainder = *this;
-        remainder.is_negative = false;
-
-        MpInt divisor = other;
-        divisor.is_negative = false;
-
-        while (compare_abs(remainder, divisor) >= 0) {
-            MpInt temp_divisor = divisor;
-            MpInt temp_quotient(1);
-
-            while (compare_abs(remainder, temp_divisor << 1) >= 0) {
-                temp_divisor = temp_divisor << 1;
-                temp_quotient = temp_quotient << 1;
-            }
+        divmod_abs(dividend, divisor, result.quotient, result.remainder);
+        result.quotient.is_negative = !result.quotient.is_zero() && dividend.is_negative != divisor.is_negative;
+        result.remainder.is_negative = !result.remainder.is_zero() && dividend.is_negative;
+        return result;
+    }
 
-            remainder = remainder - temp_divisor;
-            quotient = quotient + temp_quotient;
+    // Operator deleni
+    template <std::size_t OtherMaxBytes>
+    MpInt operator/(const MpInt<OtherMaxBytes>& other) const {
+        if (other.is_zero()) {
+            throw std::invalid_argument("Deleni nulou.");
         }
-
-        quotient.is_negative = (is_negative != other.is_negative);
-        quotient.remove_leading_zeros();
-        quotient.ensure_valid_size();
-        return quotient;
+        return divmod(*this, other).quotient;
     }
 
     // Operator modulo
     template <std::size_t OtherMaxBytes>
     MpInt operator%(const MpInt<OtherMaxBytes>& other) const {
-        if (other == MpInt(0)) {
+        if (other.is_zero()) {
             throw std::invalid_argument("Modulo nulou.");
         }
+        return divmod(*this, other).remainder;
+    }
 
-        if (other.chunks.size() == 1 && other.chunks[0] == 1) {
-            return MpInt(0);
-        }
+    // Deleni 32-bitovym celym cislem
+    void divide_by_uint32(uint32_t divisor, MpInt& quotient, uint32_t& remainder) const {
+        const std::size_t num_chunks = chunks.size();
+        quotient.chunks.resize(num_chunks);
+        quotient.is_negative = false; // Vysledek je nezaporny
 
-        if (compare_abs(*this, other) < 0) {
-            return *this;
+        // Zpracovani chunku od nejvyznamnejsiho po nejmene vyznamny (quotient muze byt i *this)
+        uint64_t current_remainder = 0;
+        for (std::size_t i = num_chunks; i-- > 0;) {
+            const limb_t chunk = chunks[i];
+            if constexpr (LimbBits == 64) {
+                // Dve deleni 64/32 bitu misto pomale 128bitove instrukce
+                uint64_t current = (current_remainder << 32) | (static_cast<uint64_t>(chunk) >> 32);
+                const uint64_t q_high = current / divisor;
+                current_remainder = current % divisor;
+                current = (current_remainder << 32) | (chunk & 0xFFFFFFFF);
+                const uint64_t q_low = current / divisor;
+                current_remainder = current % divisor;
+                quotient.chunks[i] = static_cast<limb_t>((q_high << 32) | q_low);
+            }
+            else {
+                current_remainder = (current_remainder << 32) | chunk;
+                quotient.chunks[i] = static_cast<limb_t>(current_remainder / divisor);
+                current_remainder %= divisor;
+            }
         }
 
-        MpInt remainder = *this;
-        remainder.is_negative = false;
-
-        MpInt divisor = other;
-        divisor.is_negative = false;
+        if (quotient.chunks.empty()) {
+            quotient.chunks.push_back(0);
+        }
+        quotient.remove_leading_zeros();
+        remainder = static_cast<uint32_t>(current_remainder);
+    }
 
-        while (compare_abs(remainder, divisor) >= 0) {
-            MpInt temp_divisor = divisor;
+    // Pricteni maleho cisla na miste
+    constexpr MpInt& add_small(uint32_t value) {
+        add_limb_in_place(value, false);
+        return *this;
+    }
 
-            while (compare_abs(remainder, temp_divisor << 1) >= 0) {
-                temp_divisor = temp_divisor << 1;
-            }
+    // Odecteni maleho cisla na miste
+    constexpr MpInt& sub_small(uint32_t value) {
+        add_limb_in_place(value, true);
+        return *this;
+    }
 
-            remainder = remainder - temp_divisor;
+    // Nasobeni malym cislem na miste (znamenko se zachovava)
+    constexpr MpInt& mul_small(uint32_t value) {
+        if (value == 0) {
+            chunks.assign(1, 0);
+            is_negative = false;
+            return *this;
+        }
+        // Soucin ma bx + bv - 1 nebo bx + bv bitu
+        const std::size_t bits = bit_length() + static_cast<std::size_t>(std::bit_width(value));
+        check_predicted_bits(bits - 1);
+        if (fits_bits(bits)) {
+            mul_add_limb<false>(value, 0);
+        }
+        else {
+            mul_add_limb(value, 0);
+            ensure_valid_size();
         }
+        return *this;
+    }
 
-        remainder.is_negative = is_negative;
-        remainder.remove_leading_zeros();
-        remainder.ensure_valid_size();
+    // Deleni malym cislem na miste (podil se zaokrouhluje k nule), vraci absolutni hodnotu zbytku
+    uint32_t divmod_small(uint32_t divisor) {
+        if (divisor == 0) {
+            throw std::invalid_argument("Deleni nulou.");
+        }
+        const bool negative = is_negative;
+        uint32_t remainder;
+        divide_by_uint32(divisor, *this, remainder);
+        is_negative = negative && !is_zero();
         return remainder;
     }
 
-
-
-    // Deleni 32-bitovym celym cislem
-    void divide_by_uint32(uint32_t divisor, MpInt& quotient, uint32_t& remainder) const {
-        quotient.chunks.clear();
-        quotient.is_negative = false; // Vysledek je nezaporny
-
-        uint64_t current_remainder = 0;
-        std::vector<uint32_t> quotient_chunks;
-
-        // Zpracovani chunku od nejvyznamnejsiho po nejmene vyznamny
-        for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
-            current_remainder = (current_remainder << 32) | *it;
-            uint32_t q = static_cast<uint32_t>(current_remainder / divisor);
-            current_remainder %= divisor;
-            quotient_chunks.push_back(q);
+    // Porovnani s nativnim cislem (-1, 0, 1) bez docasneho MpInt
+    constexpr int compare_small(int64_t value) const {
+        const bool value_negative = value < 0;
+        if (is_negative != value_negative) {
+            return is_negative ? -1 : 1;
         }
 
-        // Chunky podilu jsou ulozeny v opacnem poradi (od MSB k LSB)
-        std::reverse(quotient_chunks.begin(), quotient_chunks.end());
-        quotient.chunks = quotient_chunks;
-        quotient.remove_leading_zeros();
-        remainder = static_cast<uint32_t>(current_remainder);
+        const uint64_t magnitude = value_negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        int abs_comparison;
+        if (chunks.size() > 64 / LimbBits) {
+            abs_comparison = 1;
+        }
+        else {
+            uint64_t own = chunks[0];
+            if constexpr (LimbBits == 32) {
+                if (chunks.size() > 1) own |= static_cast<uint64_t>(chunks[1]) << 32;
+            }
+            abs_comparison = own < magnitude ? -1 : own > magnitude ? 1 : 0;
+        }
+        return is_negative ? -abs_comparison : abs_comparison;
     }
 
     // Operator -
-    MpInt operator-() const {
+    constexpr MpInt operator-() const {
         MpInt result = *this;
-        if (result != MpInt(0)) {
+        if (!result.is_zero()) {
             result.is_negative = !is_negative;
         }
         return result;
     }
 
-    // Operator += 
-    MpInt operator+=(const MpInt& other) {
-        *this = *this + other;
+    // Operator += (na miste)
+    constexpr MpInt& operator+=(const MpInt& other) {
+        add_signed_in_place(other, other.is_negative);
         return *this;
     }
 
-    // Operator += pro int 
-    MpInt operator+=(const int x) {
-        *this = *this + MpInt(x);
+    // Operator += pro int
+    constexpr MpInt& operator+=(const int x) {
+        add_limb_in_place(int_magnitude(x), x < 0);
         return *this;
     }
 
-    // Operator -= 
-    MpInt operator-=(const MpInt& other) {
-        *this = *this - other;
+    // Operator -= (na miste)
+    constexpr MpInt& operator-=(const MpInt& other) {
+        add_signed_in_place(other, !other.is_negative);
         return *this;
     }
 
-    // Operator -= pro int 
-    MpInt operator-=(const int x) {
-        *this = *this - MpInt(x);
+    // Operator -= pro int
+    constexpr MpInt& operator-=(const int x) {
+        add_limb_in_place(int_magnitude(x), x > 0);
         return *this;
     }
 
-    // Operator *=
-    MpInt operator*=(const MpInt& other) {
-        *this = *this * other;
+    // Operator *= (jednolimbovy cinitel na miste, jinak soucin presunem do *this)
+    constexpr MpInt& operator*=(const MpInt& other) {
+        if (other.chunks.size() == 1) {
+            const bool negative = is_negative != other.is_negative;
+            if (is_zero() || other.is_zero()) {
+                chunks.assign(1, 0);
+                is_negative = false;
+                return *this;
+            }
+            const std::size_t bits = bit_length() + static_cast<std::size_t>(std::bit_width(other.chunks[0]));
+            check_predicted_bits(bits - 1);
+            mul_add_limb<false>(other.chunks[0], 0);
+            is_negative = negative;
+            if (!fits_bits(bits)) {
+                ensure_valid_size();
+            }
+            return *this;
+        }
+        *this = fused_multiply<false>(*this, other, false, nullptr, false);
         return *this;
     }
 
     // Operator *= pro int
-    MpInt operator*=(const int x) {
-        *this = *this * MpInt(x);
+    constexpr MpInt& operator*=(const int x) {
+        mul_small(static_cast<uint32_t>(int_magnitude(x)));
+        if (x < 0 && !is_zero()) {
+            is_negative = !is_negative;
+        }
         return *this;
     }
 
     // Operator /=
-    MpInt operator/=(const MpInt& other) {
-        *this = *this / other;
+    MpInt& operator/=(const MpInt& other) {
+        *this = divmod(*this, other).quotient;
         return *this;
     }
 
     // Operator /= pro int
-    MpInt operator/=(const int x) {
-        *this = *this / MpInt(x);
+    MpInt& operator/=(const int x) {
+        divmod_small(static_cast<uint32_t>(int_magnitude(x)));
+        if (x < 0 && !is_zero()) {
+            is_negative = !is_negative;
+        }
         return *this;
     }
 
-    // operator inkrementace
-    MpInt operator++() {
-        *this += 1;
+    // Operator %=
+    MpInt& operator%=(const MpInt& other) {
+        *this = divmod(*this, other).remainder;
         return *this;
     }
 
-    // operator dekrementace
-    MpInt operator--() {
+    // Operator inkrementace (prefixovy)
+    constexpr MpInt& operator++() {
+        return *this += 1;
+    }
+
+    // Operator inkrementace (postfixovy)
+    constexpr MpInt operator++(int) {
+        MpInt previous = *this;
+        *this += 1;
+        return previous;
+    }
+
+    // Operator dekrementace (prefixovy)
+    constexpr MpInt& operator--() {
+        return *this -= 1;
+    }
+
+    // Operator dekrementace (postfixovy)
+    constexpr MpInt operator--(int) {
+        MpInt previous = *this;
         *this -= 1;
-        return *this;
+        return previous;
     }
 
     // Operator rovnosti
-    bool operator==(const MpInt& other) const {
+    constexpr bool operator==(const MpInt& other) const {
         return is_negative == other.is_negative && chunks == other.chunks;
     }
 
     // Operator nerovnosti 
-    bool operator!=(const MpInt& other) const {
+    constexpr bool operator!=(const MpInt& other) const {
         return !(*this == other);
     }
 
     // Operator mensi nez 
-    bool operator<(const MpInt& other) const {
+    constexpr bool operator<(const MpInt& other) const {
         if (is_negative != other.is_negative) {
             return is_negative;
         }
@@ -512,17 +2259,17 @@ public:
     }
 
     // Operator mensi nebo rovno
-    bool operator<=(const MpInt& other) const {
+    constexpr bool operator<=(const MpInt& other) const {
         return *this < other || *this == other;
     }
 
     // Operator vetsi nez
-    bool operator>(const MpInt& other) const {
+    constexpr bool operator>(const MpInt& other) const {
         return !(*this <= other);
     }
 
     // Operator vetsi nebo rovno 
-    bool operator>=(const MpInt& other) const {
+    constexpr bool operator>=(const MpInt& other) const {
         return !(*this < other);
     }
 
@@ -535,86 +2282,103 @@ public:
     }
 
     // Operator bitoveho posunu doleva
-    MpInt operator<<(uint32_t shift) const {
+    constexpr MpInt operator<<(uint32_t shift) const {
         MpInt result = *this;
         result.leftShift(shift);
         return result;
     }
 
     // Pomocna metoda pro bitovy posun doleva
-    void leftShift(uint32_t shift) {
+    constexpr void leftShift(uint32_t shift) {
         if (shift == 0) return;
 
-        uint32_t chunk_shift = shift / 32;
-        uint32_t bit_shift = shift % 32;
-
-        std::vector<uint32_t> new_chunks;
-        new_chunks.reserve(chunks.size() + chunk_shift + 1);
+        const std::size_t chunk_shift = shift / LimbBits;
+        const unsigned bit_shift = shift % LimbBits;
+        const std::size_t old_size = chunks.size();
 
-        // Pridani uvodnich nul pro chunk_shift
-        new_chunks.insert(new_chunks.end(), chunk_shift, 0);
+        // Vysledek ma presne bity + shift bitu, preteceni se tak pozna pred posunem (dalsi kontrola neni potreba)
+        if (!is_zero()) {
+            check_predicted_bits(bit_length() + shift);
+        }
 
-        uint32_t carry = 0;
-        for (uint32_t chunk : chunks) {
-            new_chunks.push_back((chunk << bit_shift) | carry);
-            carry = (bit_shift > 0) ? (chunk >> (32 - bit_shift)) : 0;
+        // Posun na miste: rozsireni a zapis od nejvyssiho chunku
+        chunks.resize(old_size + chunk_shift + 1, 0);
+        for (std::size_t i = old_size; i-- > 0;) {
+            const limb_t chunk = chunks[i];
+            if (bit_shift > 0) {
+                chunks[i + chunk_shift + 1] |= chunk >> (LimbBits - bit_shift);
+                chunks[i + chunk_shift] = chunk << bit_shift;
+            }
+            else {
+                chunks[i + chunk_shift] = chunk;
+            }
         }
+        std::fill(chunks.begin(), chunks.begin() + chunk_shift, 0);
 
-        if (carry > 0) {
-            new_chunks.push_back(carry);
+        remove_leading_zeros();
+    }
+
+    // Operator bitoveho posunu doprava (posouva absolutni hodnotu)
+    constexpr MpInt operator>>(uint32_t shift) const {
+        MpInt result = *this;
+        result.rightShift(shift);
+        return result;
+    }
+
+    // Pomocna metoda pro bitovy posun doprava
+    constexpr void rightShift(uint32_t shift) {
+        if (shift == 0) return;
+
+        const std::size_t chunk_shift = shift / LimbBits;
+        if (chunk_shift >= chunks.size()) {
+            chunks.assign(1, 0);
+            is_negative = false;
+            return;
         }
 
-        chunks = std::move(new_chunks);
-        ensure_valid_size();
+        // Posun o cele chunky a pak o zbyvajici bity na miste
+        const std::size_t remaining = chunks.size() - chunk_shift;
+        std::copy(chunks.begin() + chunk_shift, chunks.end(), chunks.begin());
+        chunks.resize(std::min(remaining, chunks.size()));  // Jen zkraceni (GCC jinak hlasi falesne -Wstringop-overflow)
+        mp_detail::rshift(limbs(), limbs(), shift % LimbBits);
+        remove_leading_zeros();
     }
 
     // Prevod MpInt na retezec
     std::string to_string() const {
-        if (*this == MpInt(0)) {
+        if (is_zero()) {
             return "0";
         }
 
-        MpInt temp = *this;
-        temp.is_negative = false;
-        std::ostringstream oss;
-        if (is_negative) {
-            oss << "-";
-        }
-
-        const uint32_t divisor = 1000000000; // 10^9
-        std::vector<std::string> digit_groups;
-
-        while (temp != MpInt(0)) {
-            MpInt quotient;
-            uint32_t remainder;
-            temp.divide_by_uint32(divisor, quotient, remainder);
-            temp = quotient;
+        MpInt magnitude = *this;
+        magnitude.is_negative = false;
+        std::string result;
 
-            // Konverze zbytku na 9mistny retezec (s doplnenim nul)
-            char buffer[10]; // 9 cislic + ukoncovaci znak
-            snprintf(buffer, sizeof(buffer), "%09u", remainder);
-            digit_groups.push_back(buffer);
-        }
-
-        // Spojeni skupin a odstraneni uvodnich nul 
-        bool first_group = true;
-        for (auto it = digit_groups.rbegin(); it != digit_groups.rend(); ++it) {
-            if (first_group) {
-                size_t start = it->find_first_not_of('0');
-                if (start != std::string::npos) {
-                    oss << it->substr(start);
-                }
-                else {
-                    oss << "0";
+        if constexpr (is_unlimited) {
+            // Velka cisla: deleni napul mocninami 10^(DecimalChunkDigits * 2^k) primo do jednoho retezce
+            if (chunks.size() > TO_STRING_THRESHOLD) {
+                std::size_t level = 0;
+                while (compare_abs(decimal_power(level), magnitude) <= 0) {
+                    ++level;
                 }
-                first_group = false;
-            }
-            else {
-                oss << *it;
+                result.assign(std::size_t(DecimalChunkDigits) << level, '0');
+                write_decimal(magnitude, level, result.data());
             }
         }
 
-        return oss.str();
+        if (result.empty()) {
+            // Kazdy chunk dava mene nez DecimalChunkDigits + 1 cislic
+            const std::size_t groups = (chunks.size() * (DecimalChunkDigits + 1) + DecimalChunkDigits - 1) / DecimalChunkDigits;
+            result.assign(groups * DecimalChunkDigits, '0');
+            write_decimal_basecase(magnitude, result.data(), result.size());
+        }
+
+        // Odstraneni uvodnich nul a doplneni znamenka
+        result.erase(0, result.find_first_not_of('0'));
+        if (is_negative) {
+            result.insert(result.begin(), '-');
+        }
+        return result;
     }
 
     // Konstrukce MpInt z retezce
@@ -625,16 +2389,93 @@ public:
 
         bool is_negative = (str[0] == '-');
         std::size_t start_idx = (is_negative || str[0] == '+') ? 1 : 0;
+        if (start_idx == str.size()) {
+            throw std::invalid_argument("Retezec neobsahuje cislice: " + str);
+        }
 
-        MpInt result;
         for (std::size_t i = start_idx; i < str.size(); ++i) {
-            if (!std::isdigit(str[i])) {
+            if (!std::isdigit(static_cast<unsigned char>(str[i]))) {
                 throw std::invalid_argument("Neplatny znak v retezci: " + str);
             }
-            result = result * MpInt(10) + MpInt(static_cast<int64_t>(str[i] - '0'));
         }
 
-        result.is_negative = is_negative;
+        // Dlouhe vstupy rekurzivne s mocninami deseti, omezena presnost vzdy po skupinach
+        MpInt result;
+        if constexpr (is_unlimited) {
+            result = parse_decimal(str.data() + start_idx, str.size() - start_idx);
+        }
+        else {
+            result = parse_decimal_basecase(str.data() + start_idx, str.size() - start_idx);
+        }
+
+        result.is_negative = is_negative && !result.is_zero();
+        result.ensure_valid_size();
+        return result;
+    }
+
+    // Prevod MpInt na sestnactkovy retezec (male cislice, bez predpony)
+    std::string to_hex() const {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+
+        std::string result;
+        result.reserve(chunks.size() * (LimbBits / 4) + 1);
+        if (is_negative && !is_zero()) {
+            result.push_back('-');
+        }
+
+        // Nejvyssi chunk bez uvodnich nul, ostatni vzdy celou sirkou
+        bool leading = true;
+        for (std::size_t i = chunks.size(); i-- > 0;) {
+            for (unsigned shift = LimbBits; shift > 0;) {
+                shift -= 4;
+                const unsigned nibble = static_cast<unsigned>((chunks[i] >> shift) & 0xF);
+                if (leading && nibble == 0) continue;
+                leading = false;
+                result.push_back(hex_digits[nibble]);
+            }
+        }
+
+        if (leading) {
+            result.push_back('0');
+        }
+        return result;
+    }
+
+    // Konstrukce MpInt ze sestnactkoveho retezce (volitelne znamenko a predpona 0x)
+    static MpInt from_hex(const std::string& str) {
+        bool is_negative = !str.empty() && str[0] == '-';
+        std::size_t start_idx = (is_negative || (!str.empty() && str[0] == '+')) ? 1 : 0;
+        if (str.compare(start_idx, 2, "0x") == 0 || str.compare(start_idx, 2, "0X") == 0) {
+            start_idx += 2;
+        }
+        if (start_idx >= str.size()) {
+            throw std::invalid_argument("Retezec neobsahuje sestnactkove cislice: " + str);
+        }
+
+        // Uvodni nuly neovlivni hodnotu ani potrebny pocet chunku
+        while (start_idx + 1 < str.size() && str[start_idx] == '0') {
+            ++start_idx;
+        }
+
+        const std::size_t length = str.size() - start_idx;
+        const std::size_t digits_per_chunk = LimbBits / 4;
+        const std::size_t needed = (length + digits_per_chunk - 1) / digits_per_chunk;
+        if constexpr (!is_unlimited) {
+            if (needed > FixedCapacity) {
+                throw std::overflow_error("Preteceni: sestnactkovy retezec je prilis dlouhy");
+            }
+        }
+
+        // Kazda cislice jde primo na svou bitovou pozici
+        MpInt result;
+        result.chunks.assign(needed, 0);
+        for (std::size_t i = 0; i < length; ++i) {
+            const limb_t nibble = hex_digit_value(str[str.size() - 1 - i]);
+            result.chunks[i / digits_per_chunk] |= nibble << (4 * (i % digits_per_chunk));
+        }
+
+        result.remove_leading_zeros();
+        result.is_negative = is_negative && !result.is_zero();
         result.ensure_valid_size();
         return result;
     }
@@ -655,25 +2496,243 @@ public:
         return chunks[0] <= std::numeric_limits<uint32_t>::max();
     }
 
-    // Vypocet faktorialu s vyuzitim predpocitanych hodnot a rozsahu soucinu
+    // Vypocet faktorialu algoritmem prime swing: licha cast z prvociselneho rozkladu, mocnina dvojky posunem
     static MpInt<MaxBytes> factorial(uint32_t n) {
-        static std::map<uint32_t, MpInt<MaxBytes>> precomputed = initializePrecomputed();
+        if (n < SmallFactorials.size()) {
+            return MpInt<MaxBytes>(SmallFactorials[n]);
+        }
+        if constexpr (!is_unlimited) {
+            // Stirling: n! > (n / e)^n, tedy log2(n!) > n * (log2(n) - log2(e)) (bit rezervy na zaokrouhleni)
+            const double lower_bits = n * (std::log2(static_cast<double>(n)) - std::numbers::log2e);
+            if (lower_bits > MaxBits + 1.0) {
+                check_predicted_bits(static_cast<std::size_t>(lower_bits) - 1);
+            }
+        }
+        if (n <= mp_detail::FactorialTableLimit) {
+            return factorial_from_table(n);
+        }
+
+        // n! obsahuje dvojku s exponentem n - popcount(n)
+        MpInt<MaxBytes> result = odd_factorial(n, primes_up_to(n));
+        result.leftShift(n - static_cast<uint32_t>(std::popcount(n)));
+        return result;
+    }
+
+    // Faktorial n! z jiz znameho k! (k <= n): soucin cisel k + 1 .. n bez dvojek se baleji do limbu a nasobi
+    // vyvazene, dvojky se doplni jednim posunem
+    static MpInt factorial_from(const MpInt& k_factorial, uint32_t k, uint32_t n) {
+        if (k > n) {
+            throw std::invalid_argument("Vychozi faktorial musi byt mensi nez n.");
+        }
+        std::vector<limb_t> factors;
+        limb_t packed = 1;
+        uint64_t twos = 0;
+        for (uint64_t i = static_cast<uint64_t>(k) + 1; i <= n; ++i) {
+            const int zeros = std::countr_zero(i);
+            twos += static_cast<uint64_t>(zeros);
+            if ((i >> zeros) > 1) {
+                push_packed_factor(factors, packed, static_cast<limb_t>(i >> zeros));
+            }
+        }
+        if (packed > 1) {
+            factors.push_back(packed);
+        }
+
+        MpInt result = factors.empty() ? k_factorial : MpInt(k_factorial * product_limbs(factors.data(), factors.size()));
+        result.leftShift(static_cast<uint32_t>(twos));
+        return result;
+    }
+
+    // Kombinacni cislo C(n, k) z prvociselneho rozkladu (Kummerova veta), mocnina dvojky posunem
+    static MpInt binomial(uint32_t n, uint32_t k) {
+        if (k > n) {
+            return MpInt();
+        }
+        k = std::min(k, n - k);
+        if (k == 0) {
+            return MpInt(1);
+        }
+        if constexpr (!is_unlimited) {
+            // log2 C(n, k) z logaritmu funkce gama (bit rezervy na zaokrouhleni)
+            const double lower_bits = (std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0)) / std::numbers::ln2;
+            if (lower_bits > MaxBits + 1.0) {
+                check_predicted_bits(static_cast<std::size_t>(lower_bits) - 1);
+            }
+        }
 
-        if (n < 2) {
-            return MpInt<MaxBytes>(1);
+        // Pro male k je soucin k cinitelu a deleni k! levnejsi nez sito do n (namereno: prechod kolem k^1.5 = n,
+        // C(10^8, 10^4) za 4.6 ms misto 340 ms). Citatel muze pretect i pri platnem vysledku, omezeny typ ho pocita
+        // v neomezene presnosti
+        if (static_cast<double>(k) * k * k <= static_cast<double>(n) * n) {
+            if constexpr (is_unlimited) {
+                return direct_binomial(n, k);
+            }
+            else {
+                return narrow(MpInt<Unlimited>::direct_binomial(n, k), MpOverflowMode::Throw);
+            }
         }
 
-        // Hledani nejvetsi predpocitane hodnoty <= n
-        auto it = precomputed.upper_bound(n);
-        if (it != precomputed.begin()) --it;
+        // Exponent dvojky je pocet prenosu pri binarnim scitani k + (n - k)
+        MpInt result = odd_binomial(n, k);
+        result.leftShift(static_cast<uint32_t>(std::popcount(k) + std::popcount(n - k) - std::popcount(n)));
+        return result;
+    }
+
+    // Fibonacciho cislo F(n) zdvojovanim pres ctverce (omezeny typ pocita v neomezene presnosti,
+    // posledni krok muze projit i F(n + 1))
+    static MpInt fibonacci(uint32_t n) {
+        if (n == 0) {
+            return MpInt();
+        }
+        if constexpr (!is_unlimited) {
+            // F(n) >= phi^(n - 2)
+            const double lower_bits = (n - 2.0) * std::log2(std::numbers::phi) * (1.0 - 1e-9);
+            if (lower_bits > MaxBits) {
+                check_predicted_bits(static_cast<std::size_t>(lower_bits) + 1);
+            }
+        }
 
-        uint32_t base = it->first;
-        MpInt<MaxBytes> result = it->second;
+        if constexpr (is_unlimited) {
+            MpInt f;
+            MpInt g;
+            fibonacci_pair(n, f, g);
+            return f;
+        }
+        else {
+            using Wide = MpInt<Unlimited>;
+            Wide f;
+            Wide g;
+            Wide::fibonacci_pair(n, f, g);
+            return narrow(f, MpOverflowMode::Throw);
+        }
+    }
 
-        if (base < n) {
-            result = result * productRange(base + 1, n);
+    // Nejvetsi spolecny delitel (nezaporny): Lehmerovy kroky, pro velka cisla rekurzivni polovicni GCD
+    // (mezivysledky v neomezene presnosti, omezeny typ by pri nich pretekl)
+    static MpInt gcd(const MpInt& a, const MpInt& b) {
+        using Wide = MpInt<Unlimited>;
+        Wide x = widen<Unlimited>(a);
+        Wide y = widen<Unlimited>(b);
+        x.is_negative = false;
+        y.is_negative = false;
+        if (Wide::compare_abs(x, y) < 0) {
+            std::swap(x, y);
         }
+        Wide::gcd_reduce(x, y, nullptr);
+        return narrow(x, MpOverflowMode::Throw);
+    }
 
+    // Nejmensi spolecny nasobek (nezaporny)
+    static MpInt lcm(const MpInt& a, const MpInt& b) {
+        if (a.is_zero() || b.is_zero()) {
+            return MpInt();
+        }
+        MpInt result = (a / gcd(a, b)) * b;
+        result.is_negative = false;
         return result;
     }
-};
\ No newline at end of file
+
+    // Rozsireny Eukleiduv algoritmus: gcd = a * x + b * y, x je zvolen v intervalu (-|b| / 2gcd, |b| / 2gcd]
+    static MpXgcdResult<MaxBytes> xgcd(const MpInt& a, const MpInt& b) {
+        using Wide = MpInt<Unlimited>;
+        const Wide wide_a = widen<Unlimited>(a);
+        const Wide wide_b = widen<Unlimited>(b);
+        const bool swapped = compare_abs(a, b) < 0;
+        Wide g = swapped ? wide_b : wide_a;
+        Wide r = swapped ? wide_a : wide_b;
+        g.is_negative = false;
+        r.is_negative = false;
+
+        typename Wide::GcdCofactors cofactors;
+        Wide::gcd_reduce(g, r, &cofactors);
+        Wide x = swapped ? cofactors.u1 : cofactors.u0;
+        Wide y = swapped ? cofactors.u0 : cofactors.u1;
+        if (a.is_negative) x = -x;
+        if (b.is_negative) y = -y;
+
+        // Kofaktory jsou urceny az na nasobky |b| / gcd, volba nejmensiho x (y se dopocita)
+        if (!g.is_zero() && !b.is_zero()) {
+            Wide period = wide_b / g;
+            period.is_negative = false;
+            x = x % period;
+            if (x.is_negative) {
+                x += period;
+            }
+            if (Wide::compare_abs(x << 1, period) > 0) {
+                x -= period;
+            }
+            y = (g - wide_a * x) / wide_b;
+        }
+        return { narrow(g, MpOverflowMode::Throw), narrow(x, MpOverflowMode::Throw), narrow(y, MpOverflowMode::Throw) };
+    }
+
+    // Celociselna druha odmocnina floor(sqrt(n)) pro n >= 0
+    static MpInt isqrt(const MpInt& n) {
+        if (n.is_negative) {
+            throw std::invalid_argument("Odmocnina ze zaporneho cisla.");
+        }
+        return iroot(n, 2);
+    }
+
+    // Celociselna k-ta odmocnina zaokrouhlena k nule (pro liche k i ze zaporneho cisla)
+    static MpInt iroot(const MpInt& n, uint32_t k) {
+        if (k == 0) {
+            throw std::invalid_argument("Odmocnina nulteho stupne neni definovana.");
+        }
+        if (n.is_negative && k % 2 == 0) {
+            throw std::invalid_argument("Suda odmocnina ze zaporneho cisla.");
+        }
+        using Wide = MpInt<Unlimited>;
+        Wide value = widen<Unlimited>(n);
+        value.is_negative = false;
+        bool exact;
+        Wide root = Wide::root_abs(value, k, exact);
+        root.is_negative = n.is_negative && !root.is_zero();
+        return narrow(root, MpOverflowMode::Throw);
+    }
+
+    // Test, zda n = m^k pro nejake cele m a k >= 2 (staci prvociselne k, zaporne n jen s lichym k)
+    static bool is_perfect_power(const MpInt& n) {
+        using Wide = MpInt<Unlimited>;
+        Wide value = widen<Unlimited>(n);
+        value.is_negative = false;
+        if (value.compare_small(1) <= 0) {
+            return true;
+        }
+
+        // Exponent mocniny deli pocet dvojek v rozkladu n, p-tou mocninou pak musi byt licha cast
+        const std::size_t twos = value.trailing_zero_bits();
+        const Wide odd = value >> static_cast<uint32_t>(twos);
+        const std::size_t odd_bits = odd.bit_length();
+        if (odd_bits == 1) {
+            // n = 2^twos, staci jeden povoleny prvociselny delitel twos
+            return twos > 1 && (!n.is_negative || (twos >> std::countr_zero(twos)) > 1);
+        }
+        // Licha cast >= 3 ma jako p-ta mocnina vic nez p bitu
+        for (const uint32_t p : Wide::primes_up_to(static_cast<uint32_t>(odd_bits - 1))) {
+            if ((n.is_negative && p == 2) || (twos > 0 && twos % p != 0)) {
+                continue;
+            }
+            if (Wide::is_odd_power(odd, p)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Modularni inverze a^-1 mod m v intervalu [0, m)
+    static MpInt invmod(const MpInt& a, const MpInt& m) {
+        if (m.is_negative || m.is_zero()) {
+            throw std::invalid_argument("Modul musi byt kladny.");
+        }
+        const MpXgcdResult<MaxBytes> result = xgcd(a, m);
+        if (result.gcd.compare_small(1) != 0) {
+            throw std::invalid_argument("Hodnota nema inverzi modulo " + m.to_string());
+        }
+        MpInt inverse = result.x % m;
+        if (inverse.is_negative) {
+            inverse += m;
+        }
+        return inverse;
+    }
+};
\ No newline at end of file
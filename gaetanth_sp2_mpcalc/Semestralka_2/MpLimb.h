@@ -0,0 +1,456 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include "MpSimd.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+// Volba sirky limbu (chunku) pri prekladu: -DMPINT_LIMB_BITS=32 nebo 64
+#ifndef MPINT_LIMB_BITS
+#if defined(__SIZEOF_INT128__) || (defined(_MSC_VER) && defined(_M_X64))
+#define MPINT_LIMB_BITS 64
+#else
+#define MPINT_LIMB_BITS 32
+#endif
+#endif
+
+#if MPINT_LIMB_BITS == 64 && !defined(__SIZEOF_INT128__) && !(defined(_MSC_VER) && defined(_M_X64))
+#error "64bitove limby vyzaduji unsigned __int128 nebo MSVC x64 intrinsiky"
+#endif
+
+// Zakladni operace nad jednotlivymi limby
+namespace mp_detail {
+
+#if MPINT_LIMB_BITS == 64
+    using limb_t = uint64_t;
+#elif MPINT_LIMB_BITS == 32
+    using limb_t = uint32_t;
+#else
+#error "MPINT_LIMB_BITS musi byt 32 nebo 64"
+#endif
+
+    inline constexpr unsigned LimbBits = MPINT_LIMB_BITS;
+
+#if MPINT_LIMB_BITS == 64 && defined(__SIZEOF_INT128__)
+    // Dvojlimb pro soucin a deleni (rozsireni prekladace, __extension__ potlaci -Wpedantic)
+    __extension__ typedef unsigned __int128 wide_limb_t;
+#endif
+
+    // Soucet s prenosem: vraci a + b + carry, novy prenos zapise do carry
+    constexpr limb_t add_carry(limb_t a, limb_t b, limb_t& carry) {
+#if MPINT_LIMB_BITS == 64 && (defined(__x86_64__) || defined(_M_X64))
+        if (!std::is_constant_evaluated()) {
+            unsigned long long sum;
+            carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &sum);
+            return sum;
+        }
+#endif
+        const limb_t sum = a + b;
+        const limb_t result = sum + carry;
+        carry = static_cast<limb_t>((sum < a) | (result < sum));
+        return result;
+    }
+
+    // Rozdil s vypujckou: vraci a - b - borrow, novou vypujcku zapise do borrow
+    constexpr limb_t sub_borrow(limb_t a, limb_t b, limb_t& borrow) {
+#if MPINT_LIMB_BITS == 64 && (defined(__x86_64__) || defined(_M_X64))
+        if (!std::is_constant_evaluated()) {
+            unsigned long long diff;
+            borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &diff);
+            return diff;
+        }
+#endif
+        const limb_t diff = a - b;
+        const limb_t result = diff - borrow;
+        borrow = static_cast<limb_t>((a < b) | (diff < borrow));
+        return result;
+    }
+
+    // Soucin a * b + c + d na dvojnasobnou sirku (nemuze pretect), horni limb zapise do hi
+    constexpr limb_t mul_add(limb_t a, limb_t b, limb_t c, limb_t d, limb_t& hi) {
+#if MPINT_LIMB_BITS == 32
+        const uint64_t t = static_cast<uint64_t>(a) * b + c + d;
+        hi = static_cast<limb_t>(t >> 32);
+        return static_cast<limb_t>(t);
+#elif defined(__SIZEOF_INT128__)
+        const wide_limb_t t = static_cast<wide_limb_t>(a) * b + c + d;
+        hi = static_cast<limb_t>(t >> 64);
+        return static_cast<limb_t>(t);
+#else
+        if (std::is_constant_evaluated()) {
+            // Pri prekladu nelze pouzit intrinsiky: soucin po 32bitovych polovinach
+            const uint64_t ll = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+            const uint64_t lh = (a & 0xFFFFFFFF) * (b >> 32);
+            const uint64_t hl = (a >> 32) * (b & 0xFFFFFFFF);
+            const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+            uint64_t high = (a >> 32) * (b >> 32) + (lh >> 32) + (hl >> 32) + (mid >> 32);
+            uint64_t low = (mid << 32) | (ll & 0xFFFFFFFF);
+            limb_t carry = 0;
+            low = add_carry(low, c, carry);
+            high += carry;
+            carry = 0;
+            low = add_carry(low, d, carry);
+            hi = high + carry;
+            return low;
+        }
+        unsigned long long high;
+        unsigned long long low = _umul128(a, b, &high);
+        unsigned char cf = _addcarry_u64(0, low, c, &low);
+        _addcarry_u64(cf, high, 0, &high);
+        cf = _addcarry_u64(0, low, d, &low);
+        _addcarry_u64(cf, high, 0, &high);
+        hi = high;
+        return low;
+#endif
+    }
+
+    // Deleni dvojlimbu (hi:lo) limbem d, predpoklada hi < d
+    inline limb_t div_wide(limb_t hi, limb_t lo, limb_t d, limb_t& rem) {
+#if MPINT_LIMB_BITS == 32
+        const uint64_t n = (static_cast<uint64_t>(hi) << 32) | lo;
+        rem = static_cast<limb_t>(n % d);
+        return static_cast<limb_t>(n / d);
+#elif defined(__SIZEOF_INT128__)
+        const wide_limb_t n = (static_cast<wide_limb_t>(hi) << 64) | lo;
+        rem = static_cast<limb_t>(n % d);
+        return static_cast<limb_t>(n / d);
+#else
+        unsigned long long r;
+        const unsigned long long q = _udiv128(hi, lo, d, &r);
+        rem = r;
+        return q;
+#endif
+    }
+
+    // Odstraneni nulovych limbu na vrcholu pole
+    constexpr std::span<const limb_t> normalized(std::span<const limb_t> a) {
+        std::size_t size = a.size();
+        while (size > 0 && a[size - 1] == 0) {
+            --size;
+        }
+        return a.first(size);
+    }
+
+    // Pomocna metoda: Vektorovy soucet/rozdil prvnich n limbu, pokud je k dispozici (vraci pocet zpracovanych limbu)
+    constexpr std::size_t simd_add_sub(bool subtract, limb_t* r, const limb_t* a, const limb_t* b, std::size_t n, limb_t& carry) {
+#if MPINT_SIMD && MPINT_LIMB_BITS == 64
+        if (n >= simd::MinLimbs && !std::is_constant_evaluated()) {
+            const simd::AddFunction kernel = subtract ? simd::kernels().sub : simd::kernels().add;
+            if (kernel != nullptr) {
+                carry = kernel(r, a, b, n, carry);
+                return n;
+            }
+        }
+#else
+        (void)subtract; (void)r; (void)a; (void)b; (void)n; (void)carry;
+#endif
+        return 0;
+    }
+
+    // Porovnani poli stejne delky od nejvyssiho limbu (-1, 0, 1)
+    constexpr int compare(std::span<const limb_t> a, std::span<const limb_t> b) {
+        std::size_t i = a.size();
+#if MPINT_SIMD && MPINT_LIMB_BITS == 64
+        if (i >= simd::MinLimbs && !std::is_constant_evaluated() && simd::kernels().scan != nullptr) {
+            i = simd::kernels().scan(a.data(), b.data(), i);
+            return i == a.size() ? 0 : (a[i] < b[i] ? -1 : 1);
+        }
+#endif
+        while (i-- > 0) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // r = a + b pro |a| >= |b| a |r| = |a|, vraci prenos (r muze byt a)
+    constexpr limb_t add(std::span<limb_t> r, std::span<const limb_t> a, std::span<const limb_t> b) {
+        limb_t carry = 0;
+        std::size_t i = simd_add_sub(false, r.data(), a.data(), b.data(), b.size(), carry);
+        for (; i < b.size(); ++i) {
+            r[i] = add_carry(a[i], b[i], carry);
+        }
+        for (; i < a.size(); ++i) {
+            r[i] = add_carry(a[i], 0, carry);
+        }
+        return carry;
+    }
+
+    // r = a - b pro |a| >= |b| a |r| = |a|, vraci vypujcku (r muze byt a)
+    constexpr limb_t sub(std::span<limb_t> r, std::span<const limb_t> a, std::span<const limb_t> b) {
+        limb_t borrow = 0;
+        std::size_t i = simd_add_sub(true, r.data(), a.data(), b.data(), b.size(), borrow);
+        for (; i < b.size(); ++i) {
+            r[i] = sub_borrow(a[i], b[i], borrow);
+        }
+        for (; i < a.size(); ++i) {
+            r[i] = sub_borrow(a[i], 0, borrow);
+        }
+        return borrow;
+    }
+
+    // r += a pro |r| >= |a|, prenos se propaguje jen dokud je nenulovy
+    constexpr limb_t add_into(std::span<limb_t> r, std::span<const limb_t> a) {
+        limb_t carry = 0;
+        std::size_t i = simd_add_sub(false, r.data(), r.data(), a.data(), a.size(), carry);
+        for (; i < a.size(); ++i) {
+            r[i] = add_carry(r[i], a[i], carry);
+        }
+        for (; carry > 0 && i < r.size(); ++i) {
+            r[i] = add_carry(r[i], 0, carry);
+        }
+        return carry;
+    }
+
+    // r -= a pro |r| >= |a|, vypujcka se propaguje jen dokud je nenulova
+    constexpr limb_t sub_into(std::span<limb_t> r, std::span<const limb_t> a) {
+        limb_t borrow = 0;
+        std::size_t i = simd_add_sub(true, r.data(), r.data(), a.data(), a.size(), borrow);
+        for (; i < a.size(); ++i) {
+            r[i] = sub_borrow(r[i], a[i], borrow);
+        }
+        for (; borrow > 0 && i < r.size(); ++i) {
+            r[i] = sub_borrow(r[i], 0, borrow);
+        }
+        return borrow;
+    }
+
+    // r += b pro jeden limb b, prenos se propaguje jen dokud je nenulovy
+    constexpr limb_t add_1(std::span<limb_t> r, limb_t b) {
+        limb_t carry = b;
+        for (std::size_t i = 0; carry > 0 && i < r.size(); ++i) {
+            r[i] += carry;
+            carry = r[i] < carry;
+        }
+        return carry;
+    }
+
+    // r -= b pro jeden limb b, vypujcka se propaguje jen dokud je nenulova
+    constexpr limb_t sub_1(std::span<limb_t> r, limb_t b) {
+        limb_t borrow = b;
+        for (std::size_t i = 0; borrow > 0 && i < r.size(); ++i) {
+            const limb_t previous = r[i];
+            r[i] -= borrow;
+            borrow = r[i] > previous;
+        }
+        return borrow;
+    }
+
+    // r[0, |a|) += a * b, vraci horni limb
+    constexpr limb_t addmul_1(std::span<limb_t> r, std::span<const limb_t> a, limb_t b) {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            r[i] = mul_add(a[i], b, r[i], carry, carry);
+        }
+        return carry;
+    }
+
+    // r = a * b skolnim algoritmem, |r| = |a| + |b| a r se neprekryva s a ani b
+    constexpr void mul_basecase(std::span<limb_t> r, std::span<const limb_t> a, std::span<const limb_t> b) {
+        std::fill(r.begin(), r.end(), 0);
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a[i] == 0) continue;
+            r[i + b.size()] = addmul_1(r.subspan(i), b, a[i]);
+        }
+    }
+
+    // r = a << shift pro shift < LimbBits, |r| = |a|, vraci vysunute bity (r muze byt a)
+    constexpr limb_t lshift(std::span<limb_t> r, std::span<const limb_t> a, unsigned shift) {
+        if (shift == 0) {
+            if (r.data() != a.data()) {
+                std::copy(a.begin(), a.end(), r.begin());
+            }
+            return 0;
+        }
+        const std::size_t n = a.size();
+#if MPINT_SIMD && MPINT_LIMB_BITS == 64
+        if (n >= simd::MinLimbs && !std::is_constant_evaluated() && simd::kernels().lshift != nullptr) {
+            return simd::kernels().lshift(r.data(), a.data(), n, shift);
+        }
+#endif
+        const limb_t out = a[n - 1] >> (LimbBits - shift);
+        for (std::size_t i = n - 1; i > 0; --i) {
+            r[i] = (a[i] << shift) | (a[i - 1] >> (LimbBits - shift));
+        }
+        r[0] = a[0] << shift;
+        return out;
+    }
+
+    // r = a >> shift pro shift < LimbBits, |r| = |a|, vraci vysunute bity zarovnane nahoru (r muze byt a)
+    constexpr limb_t rshift(std::span<limb_t> r, std::span<const limb_t> a, unsigned shift) {
+        if (shift == 0) {
+            if (r.data() != a.data()) {
+                std::copy(a.begin(), a.end(), r.begin());
+            }
+            return 0;
+        }
+        const std::size_t n = a.size();
+#if MPINT_SIMD && MPINT_LIMB_BITS == 64
+        if (n >= simd::MinLimbs && !std::is_constant_evaluated() && simd::kernels().rshift != nullptr) {
+            return simd::kernels().rshift(r.data(), a.data(), n, shift);
+        }
+#endif
+        const limb_t out = a[0] << (LimbBits - shift);
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            r[i] = (a[i] >> shift) | (a[i + 1] << (LimbBits - shift));
+        }
+        r[n - 1] = a[n - 1] >> shift;
+        return out;
+    }
+
+    // r = a * a skolnim algoritmem: krizove soucty a_i * a_j (i < j) jednou, zdvojeni a pricteni ctvercu na diagonale
+    // |r| = 2|a| a r se neprekryva s a
+    constexpr void sqr_basecase(std::span<limb_t> r, std::span<const limb_t> a) {
+        const std::size_t n = a.size();
+        std::fill(r.begin(), r.end(), 0);
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            if (a[i] == 0) continue;
+            r[i + n] = addmul_1(r.subspan(2 * i + 1), a.subspan(i + 1), a[i]);
+        }
+
+        // Zdvojnasobeni krizovych souctu (nejvyssi bit je vzdy nulovy)
+        lshift(r, r, 1);
+
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            limb_t high;
+            const limb_t low = mul_add(a[i], a[i], 0, 0, high);
+            r[2 * i] = add_carry(r[2 * i], low, carry);
+            r[2 * i + 1] = add_carry(r[2 * i + 1], high, carry);
+        }
+    }
+
+    // r[0, |a|) -= a * b, vraci limb, ktery je treba odecist o pozici vys
+    inline limb_t submul_1(std::span<limb_t> r, std::span<const limb_t> a, limb_t b) {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            limb_t high;
+            const limb_t low = mul_add(a[i], b, carry, 0, high);
+            limb_t borrow = 0;
+            r[i] = sub_borrow(r[i], low, borrow);
+            carry = high + borrow;
+        }
+        return carry;
+    }
+
+    // Lehmerova aktualizace dvojice na miste (|a| = |b|): pri sudem poctu kroku a = ka * a - kb * b, b = kd * b - kc * a,
+    // pri lichem opacne rozdily. Oba vysledky jsou nezaporne a ne vetsi nez puvodni a, pocitaji se v jednom pruchodu
+    inline void lehmer_update(std::span<limb_t> a, std::span<limb_t> b, limb_t ka, limb_t kb, limb_t kc, limb_t kd, bool even) {
+        limb_t carry_aa = 0, carry_ab = 0, carry_ba = 0, carry_bb = 0;
+        limb_t borrow_a = 0, borrow_b = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const limb_t aa = mul_add(a[i], ka, carry_aa, 0, carry_aa);
+            const limb_t ab = mul_add(b[i], kb, carry_ab, 0, carry_ab);
+            const limb_t ba = mul_add(a[i], kc, carry_ba, 0, carry_ba);
+            const limb_t bb = mul_add(b[i], kd, carry_bb, 0, carry_bb);
+            a[i] = even ? sub_borrow(aa, ab, borrow_a) : sub_borrow(ab, aa, borrow_a);
+            b[i] = even ? sub_borrow(bb, ba, borrow_b) : sub_borrow(ba, bb, borrow_b);
+        }
+    }
+
+    // Kofaktory Lehmerova kroku na miste (|u| = |v|, absolutni hodnoty): u = ka * u + kb * v, v = kc * u + kd * v,
+    // koeficienty maji nejvyse LimbBits - 2 bitu, horni limby vysledku se zapisi do u_high a v_high
+    inline void lehmer_cofactors(std::span<limb_t> u, std::span<limb_t> v, limb_t ka, limb_t kb, limb_t kc, limb_t kd,
+                                 limb_t& u_high, limb_t& v_high) {
+        u_high = 0;
+        v_high = 0;
+        for (std::size_t i = 0; i < u.size(); ++i) {
+            limb_t high_a, high_b;
+            const limb_t next_u = mul_add(v[i], kb, mul_add(u[i], ka, u_high, 0, high_a), 0, high_b);
+            u_high = high_a + high_b;
+            const limb_t next_v = mul_add(v[i], kd, mul_add(u[i], kc, v_high, 0, high_a), 0, high_b);
+            v_high = high_a + high_b;
+            u[i] = next_u;
+            v[i] = next_v;
+        }
+    }
+
+    // q = a / d pro jednolimbovy delitel, |q| = |a|, vraci zbytek (q muze byt a)
+    inline limb_t divrem_1(std::span<limb_t> q, std::span<const limb_t> a, limb_t d) {
+        limb_t rem = 0;
+        for (std::size_t i = a.size(); i-- > 0;) {
+            q[i] = div_wide(rem, a[i], d, rem);
+        }
+        return rem;
+    }
+
+    // Zbytek a mod d pro d < 2^32 bez zapisu podilu (po 32bitovych pulkach, staci nativni 64bitove deleni)
+    inline uint32_t mod_1(std::span<const limb_t> a, uint32_t d) {
+        uint64_t rem = 0;
+        for (std::size_t i = a.size(); i-- > 0;) {
+            if constexpr (LimbBits == 64) {
+                rem = ((rem << 32) | static_cast<uint64_t>(a[i] >> 32)) % d;
+            }
+            rem = ((rem << 32) | static_cast<uint32_t>(a[i])) % d;
+        }
+        return static_cast<uint32_t>(rem);
+    }
+
+    // Hensel deleni lichym d: q * d = a mod B^|a| (pro a delitelne d presny podil), |q| = |a| (q muze byt a)
+    inline void bdiv_q_1(std::span<limb_t> q, std::span<const limb_t> a, limb_t d) {
+        // d^-1 mod B Newtonovou iteraci (kazdy krok zdvojnasobi pocet platnych bitu)
+        limb_t inverse = d;
+        for (unsigned bits = 3; bits < LimbBits; bits *= 2) {
+            inverse *= 2 - d * inverse;
+        }
+
+        limb_t borrow = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            limb_t under = 0;
+            const limb_t rest = sub_borrow(a[i], borrow, under);
+            q[i] = rest * inverse;
+            mul_add(q[i], d, 0, 0, borrow);
+            borrow += under;
+        }
+    }
+
+    // Knuthuv algoritmus D: un je normalizovany delenec s jednim limbem navic (na konci v nem zustane zbytek),
+    // vn normalizovany delitel (|vn| >= 2, nejvyssi bit nastaven), q ma |un| - |vn| limbu
+    inline void divrem_knuth(std::span<limb_t> q, std::span<limb_t> un, std::span<const limb_t> vn) {
+        const std::size_t n = vn.size();
+        const limb_t v_top = vn[n - 1];
+        const limb_t v_next = vn[n - 2];
+
+        for (std::size_t j = un.size() - n; j-- > 0;) {
+            // Odhad cifry podilu ze dvou nejvyssich limbu (un[j + n] <= v_top plati z invariantu)
+            limb_t q_hat;
+            limb_t r_hat;
+            limb_t r_overflow = 0;
+            if (un[j + n] == v_top) {
+                q_hat = ~limb_t(0);
+                r_hat = add_carry(un[j + n - 1], v_top, r_overflow);
+            }
+            else {
+                q_hat = div_wide(un[j + n], un[j + n - 1], v_top, r_hat);
+            }
+
+            // Korekce odhadu druhym limbem delitele (nejvyse dvakrat)
+            while (r_overflow == 0) {
+                limb_t product_high;
+                const limb_t product_low = mul_add(q_hat, v_next, 0, 0, product_high);
+                if (product_high < r_hat || (product_high == r_hat && product_low <= un[j + n - 2])) {
+                    break;
+                }
+                --q_hat;
+                r_hat = add_carry(r_hat, v_top, r_overflow);
+            }
+
+            // Odecteni q_hat * vn, pri zapornem vysledku pricteni delitele zpet
+            const limb_t borrow = submul_1(un.subspan(j, n), vn, q_hat);
+            limb_t top_borrow = 0;
+            un[j + n] = sub_borrow(un[j + n], borrow, top_borrow);
+            if (top_borrow != 0) {
+                --q_hat;
+                un[j + n] += add(un.subspan(j, n), un.subspan(j, n), vn);
+            }
+            q[j] = q_hat;
+        }
+    }
+}
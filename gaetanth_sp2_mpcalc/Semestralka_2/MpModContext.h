@@ -0,0 +1,301 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include "MpInt.h"
+
+// Modularni aritmetika nad pevnym modulem: konstanty se predpocitaji jednou v konstruktoru
+// Liche moduly pouzivaji Montgomeryho reprezentaci, sude Barrettovu redukci
+// Hodnoty v "rezidualnim tvaru" (to_residue) se mezi volanimi mulmod neprevadeji zpet
+template <std::size_t MaxBytes>
+class MpModContext final {
+private:
+    using Value = MpInt<MaxBytes>;
+    using Wide = MpInt<std::numeric_limits<std::size_t>::max()>;
+    using limb_t = mp_detail::limb_t;
+    using storage_t = typename Value::storage_t;
+    static constexpr unsigned LimbBits = mp_detail::LimbBits;
+
+    // Nejvetsi okno pro umocnovani (tabulka lichych mocnin ma 2^(MaxWindow - 1) prvku)
+    static constexpr unsigned MaxWindow = 5;
+
+    Value mod;
+    std::size_t n = 0;              // Pocet limbu modulu
+    bool montgomery = false;
+
+    limb_t inverse = 0;             // Montgomery: -m^-1 mod B
+    storage_t r_squared;            // Montgomery: R^2 mod m, R = B^n (n limbu)
+    Value one;                      // Jednicka v rezidualnim tvaru
+    storage_t barrett_mu;           // Barrett: floor(B^(2n) / m), n + 1 limbu
+
+    // Pomocna metoda: Hodnota jako pole presne n limbu (hodnota mimo [0, m) se nejdriv redukuje,
+    // verejne metody prijimaji rezidua od volajiciho a delsi hodnota by pole prepsala)
+    void load(std::span<limb_t> target, const Value& value) const {
+        std::fill(target.begin(), target.end(), 0);
+        if (value.is_negative || Value::compare_abs(value, mod) >= 0) {
+            const Value reduced = reduce(value);
+            std::copy(reduced.chunks.begin(), reduced.chunks.end(), target.begin());
+            return;
+        }
+        std::copy(value.chunks.begin(), value.chunks.end(), target.begin());
+    }
+
+    // Pomocna metoda: Prevod pole limbu na normalizovanou hodnotu
+    static Value store(std::span<const limb_t> source) {
+        Value result;
+        result.chunks.assign(source.size(), 0);
+        std::copy(source.begin(), source.end(), result.chunks.begin());
+        result.remove_leading_zeros();
+        return result;
+    }
+
+    // Pomocna metoda: Montgomeryho soucin r = a * b * R^-1 mod m (CIOS), |a| = |b| = |r| = n
+    void montgomery_multiply(std::span<limb_t> r, std::span<const limb_t> a, std::span<const limb_t> b) const {
+        storage_t buffer;
+        buffer.assign(n + 2, 0);
+        const std::span<limb_t> t(buffer.data(), n + 2);
+        const std::span<const limb_t> m = mod.limbs();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            limb_t overflow = 0;
+            t[n] = mp_detail::add_carry(t[n], mp_detail::addmul_1(t.first(n), b, a[i]), overflow);
+            t[n + 1] += overflow;
+
+            // Pricteni u * m vynuluje nejnizsi limb, ktery se pak odsune
+            const limb_t u = t[0] * inverse;
+            overflow = 0;
+            t[n] = mp_detail::add_carry(t[n], mp_detail::addmul_1(t.first(n), m, u), overflow);
+            t[n + 1] += overflow;
+            std::copy(t.begin() + 1, t.end(), t.begin());
+            t[n + 1] = 0;
+        }
+
+        // Vysledek je < 2m, staci jedno odecteni
+        if (t[n] != 0 || mp_detail::compare(t.first(n), m) >= 0) {
+            mp_detail::sub(t.first(n), t.first(n), m);
+        }
+        std::copy(t.begin(), t.begin() + n, r.begin());
+    }
+
+    // Pomocna metoda: Barrettova redukce x < m^2 (|x| = 2n) do r (|r| = n)
+    void barrett_reduce(std::span<limb_t> r, std::span<const limb_t> x) const {
+        const std::span<const limb_t> m = mod.limbs();
+        const std::span<const limb_t> mu(barrett_mu.data(), n + 1);
+
+        // q = floor(floor(x / B^(n-1)) * mu / B^(n+1)) podhodnocuje podil nejvyse o 3
+        storage_t product;
+        product.assign(2 * n + 2, 0);
+        const std::span<limb_t> q_full(product.data(), 2 * n + 2);
+        mp_detail::mul_basecase(q_full, x.subspan(n - 1), mu);
+        const std::span<const limb_t> q = std::span<const limb_t>(q_full).subspan(n + 1, n + 1);
+
+        // r = (x - q * m) mod B^(n+1)
+        storage_t qm_buffer;
+        qm_buffer.assign(2 * n + 1, 0);
+        const std::span<limb_t> qm(qm_buffer.data(), 2 * n + 1);
+        mp_detail::mul_basecase(qm, q, m);
+
+        storage_t rest_buffer;
+        rest_buffer.assign(n + 1, 0);
+        const std::span<limb_t> rest(rest_buffer.data(), n + 1);
+        mp_detail::sub(rest, x.first(n + 1), qm.first(n + 1));
+
+        while (rest[n] != 0 || mp_detail::compare(rest.first(n), m) >= 0) {
+            rest[n] -= mp_detail::sub(rest.first(n), rest.first(n), m);
+        }
+        std::copy(rest.begin(), rest.begin() + n, r.begin());
+    }
+
+    // Pomocna metoda: Soucin dvou rezidui do pole n limbu
+    void multiply_limbs(std::span<limb_t> r, std::span<const limb_t> a, std::span<const limb_t> b) const {
+        if (montgomery) {
+            montgomery_multiply(r, a, b);
+            return;
+        }
+        storage_t product;
+        product.assign(2 * n, 0);
+        const std::span<limb_t> full(product.data(), 2 * n);
+        if (a.data() == b.data()) {
+            mp_detail::sqr_basecase(full, a);
+        }
+        else {
+            mp_detail::mul_basecase(full, a, b);
+        }
+        barrett_reduce(r, full);
+    }
+
+    // Pomocna metoda: Redukce libovolne hodnoty do intervalu [0, m)
+    Value reduce(const Value& value) const {
+        Value result = value % mod;
+        if (result.is_negative) {
+            result += mod;
+        }
+        return result;
+    }
+
+    // Pomocna metoda: Bit exponentu na pozici index
+    static bool exponent_bit(const Value& exponent, std::size_t index) {
+        return (exponent.chunks[index / LimbBits] >> (index % LimbBits)) & 1;
+    }
+
+public:
+    // Konstruktor: predpocita konstanty pro modul m > 0
+    explicit MpModContext(const Value& modulus) : mod(modulus) {
+        if (modulus.is_negative || modulus.is_zero()) {
+            throw std::invalid_argument("Modul musi byt kladny.");
+        }
+        n = mod.chunks.size();
+        montgomery = (mod.chunks[0] & 1) != 0;
+
+        // Konstanty se pocitaji v neomezene presnosti (R^2 i B^(2n) mohou presahnout MaxBytes)
+        const Wide wide_mod(mod.chunks.begin(), mod.chunks.end());
+        const uint32_t wide_shift = static_cast<uint32_t>(2 * n * LimbBits);
+        if (montgomery) {
+            // Newtonova iterace pro m0^-1 mod B (kazdy krok zdvojnasobi pocet platnych bitu)
+            limb_t x = mod.chunks[0];
+            for (unsigned bits = 3; bits < LimbBits; bits *= 2) {
+                x *= 2 - mod.chunks[0] * x;
+            }
+            inverse = 0 - x;
+
+            const Wide r2 = (Wide(1) << wide_shift) % wide_mod;
+            r_squared.assign(n, 0);
+            std::copy(r2.chunks.begin(), r2.chunks.end(), r_squared.begin());
+        }
+        else {
+            // Pro m = B^(n-1) ma podil n + 2 limbu, orizne se na B^(n+1) - 1 (odhad podilu se zhorsi jen o 1)
+            const Wide mu = (Wide(1) << wide_shift) / wide_mod;
+            barrett_mu.assign(n + 1, ~limb_t(0));
+            if (mu.chunks.size() <= n + 1) {
+                std::fill(barrett_mu.begin(), barrett_mu.end(), 0);
+                std::copy(mu.chunks.begin(), mu.chunks.end(), barrett_mu.begin());
+            }
+        }
+        one = to_residue(Value(1));
+    }
+
+    // Modul
+    const Value& modulus() const {
+        return mod;
+    }
+
+    // Pouziva se Montgomeryho reprezentace (lichy modul)
+    bool is_montgomery() const {
+        return montgomery;
+    }
+
+    // Prevod hodnoty do rezidualniho tvaru (a * R mod m, pri Barrettove redukci jen a mod m)
+    Value to_residue(const Value& value) const {
+        const Value reduced = reduce(value);
+        if (!montgomery) {
+            return reduced;
+        }
+        storage_t a;
+        a.assign(n, 0);
+        storage_t r;
+        r.assign(n, 0);
+        load({ a.data(), n }, reduced);
+        montgomery_multiply({ r.data(), n }, { a.data(), n }, { r_squared.data(), n });
+        return store({ r.data(), n });
+    }
+
+    // Prevod z rezidualniho tvaru zpet na hodnotu v [0, m)
+    Value from_residue(const Value& residue) const {
+        if (!montgomery) {
+            return reduce(residue);
+        }
+        storage_t a;
+        a.assign(n, 0);
+        storage_t unit;
+        unit.assign(n, 0);
+        unit[0] = 1;
+        load({ a.data(), n }, residue);
+        storage_t r;
+        r.assign(n, 0);
+        montgomery_multiply({ r.data(), n }, { a.data(), n }, { unit.data(), n });
+        return store({ r.data(), n });
+    }
+
+    // Soucin dvou rezidui (vysledek je opet v rezidualnim tvaru)
+    Value mulmod(const Value& a, const Value& b) const {
+        storage_t x;
+        x.assign(n, 0);
+        storage_t y;
+        y.assign(n, 0);
+        load({ x.data(), n }, a);
+        load({ y.data(), n }, b);
+        storage_t r;
+        r.assign(n, 0);
+        multiply_limbs({ r.data(), n }, { x.data(), n }, &a == &b ? std::span<const limb_t>(x.data(), n) : std::span<const limb_t>(y.data(), n));
+        return store({ r.data(), n });
+    }
+
+    // Modularni mocnina base^exponent mod m klouzavym oknem (vstup i vystup v beznem tvaru)
+    // Zaporny exponent umocnuje inverzi zakladu
+    Value powmod(const Value& base, const Value& exponent) const {
+        if (exponent.is_negative) {
+            return powmod(invmod(base), -exponent);
+        }
+        if (exponent.is_zero()) {
+            return reduce(Value(1));
+        }
+
+        const std::size_t bits = (exponent.chunks.size() - 1) * LimbBits + std::bit_width(exponent.chunks.back());
+        const unsigned window = bits > 512 ? 5 : bits > 128 ? 4 : bits > 24 ? 3 : bits > 6 ? 2 : 1;
+
+        // Tabulka lichych mocnin base^1, base^3, ..., base^(2^window - 1) v rezidualnim tvaru
+        // Mezivysledky zustavaji jako pole n limbu, mezi kroky se neprevadeji na MpInt
+        std::array<storage_t, std::size_t(1) << (MaxWindow - 1)> odd_powers;
+        const std::size_t table_size = std::size_t(1) << (window - 1);
+        for (std::size_t i = 0; i < table_size; ++i) {
+            odd_powers[i].assign(n, 0);
+        }
+        load({ odd_powers[0].data(), n }, to_residue(base));
+        storage_t base_squared;
+        base_squared.assign(n, 0);
+        multiply_limbs({ base_squared.data(), n }, { odd_powers[0].data(), n }, { odd_powers[0].data(), n });
+        for (std::size_t i = 1; i < table_size; ++i) {
+            multiply_limbs({ odd_powers[i].data(), n }, { odd_powers[i - 1].data(), n }, { base_squared.data(), n });
+        }
+
+        storage_t result;
+        result.assign(n, 0);
+        load({ result.data(), n }, one);
+        storage_t product;
+        product.assign(n, 0);
+        // Pomocna lambda: result = result * factor
+        const auto multiply_into = [&](const storage_t& factor) {
+            multiply_limbs({ product.data(), n }, { result.data(), n }, { factor.data(), n });
+            std::swap(result, product);
+        };
+
+        for (std::size_t i = bits; i-- > 0;) {
+            if (!exponent_bit(exponent, i)) {
+                multiply_into(result);
+                continue;
+            }
+
+            // Okno konci jednickovym bitem, aby jeho hodnota byla licha
+            std::size_t low = i + 1 > window ? i + 1 - window : 0;
+            while (!exponent_bit(exponent, low)) {
+                ++low;
+            }
+            std::size_t value = 0;
+            for (std::size_t j = i + 1; j-- > low;) {
+                value = (value << 1) | exponent_bit(exponent, j);
+                multiply_into(result);
+            }
+            multiply_into(odd_powers[value >> 1]);
+            i = low;
+        }
+        return from_residue(store({ result.data(), n }));
+    }
+
+    // Modularni inverze (vstup i vystup v beznem tvaru)
+    Value invmod(const Value& value) const {
+        return Value::invmod(value, mod);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "MpLimb.h"
+
+// Nasobeni velkych cisel cislo-teoretickou transformaci (tri prvocisla + CRT)
+namespace mp_detail {
+
+    // Nejvetsi podporovana delka transformace (vsechna tri prvocisla maji tvar c * 2^26 + 1)
+    inline constexpr unsigned NttMaxLog = 26;
+
+    // Pocet 32bitovych cislic v jednom limbu
+    inline constexpr std::size_t NttDigitsPerLimb = LimbBits / 32;
+
+    // Maximalni soucet delek operandu (v limbech), ktery NTT zvladne bez preteceni koeficientu
+    inline constexpr std::size_t NttMaxLimbs = (std::size_t(1) << NttMaxLog) / NttDigitsPerLimb;
+
+    // Prvocislo tvaru c * 2^k + 1 s primitivnim korenem
+    template <uint32_t Mod, uint32_t Root>
+    class NttPrime final {
+    private:
+        // Tabulka korenu jednotky: uroven l obsahuje w^j pro j < 2^l, kde w je primitivni 2^(l+1)-ta odmocnina
+        // Urovne se dopocitavaji lina a jsou sdilene mezi volanimi i vlakny
+        static const std::vector<uint32_t>* root_levels(unsigned count) {
+            static std::array<std::vector<uint32_t>, NttMaxLog> levels;
+            static std::mutex guard;
+            static unsigned built = 0;
+
+            std::lock_guard<std::mutex> lock(guard);
+            for (; built < count; ++built) {
+                std::vector<uint32_t>& level = levels[built];
+                level.resize(std::size_t(1) << built);
+                if (built == 0) {
+                    level[0] = 1;
+                    continue;
+                }
+                const uint32_t w = pow(Root, (Mod - 1) >> (built + 1));
+                const std::vector<uint32_t>& previous = levels[built - 1];
+                for (std::size_t j = 0; j < level.size(); ++j) {
+                    level[j] = (j & 1) ? mul(previous[j >> 1], w) : previous[j >> 1];
+                }
+            }
+            return levels.data();
+        }
+
+    public:
+        static constexpr uint32_t modulus = Mod;
+
+        static uint32_t add(uint32_t a, uint32_t b) {
+            const uint32_t sum = a + b;
+            return sum >= Mod ? sum - Mod : sum;
+        }
+
+        static uint32_t sub(uint32_t a, uint32_t b) {
+            return a >= b ? a - b : a + Mod - b;
+        }
+
+        static uint32_t mul(uint32_t a, uint32_t b) {
+            return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % Mod);
+        }
+
+        static uint32_t pow(uint32_t base, uint64_t exponent) {
+            uint32_t result = 1;
+            for (; exponent > 0; exponent >>= 1) {
+                if (exponent & 1) result = mul(result, base);
+                base = mul(base, base);
+            }
+            return result;
+        }
+
+        // Dopredna transformace na miste (n je mocnina dvou)
+        static void transform(uint32_t* a, std::size_t n) {
+            const unsigned log_n = static_cast<unsigned>(std::countr_zero(n));
+
+            // Permutace bitove reverze
+            for (std::size_t i = 1, j = 0; i < n; ++i) {
+                std::size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j) {
+                    std::swap(a[i], a[j]);
+                }
+            }
+
+            const std::vector<uint32_t>* levels = root_levels(log_n);
+            for (unsigned level = 0; level < log_n; ++level) {
+                const std::size_t half = std::size_t(1) << level;
+                const uint32_t* w = levels[level].data();
+                for (std::size_t i = 0; i < n; i += 2 * half) {
+                    for (std::size_t j = 0; j < half; ++j) {
+                        const uint32_t z = mul(w[j], a[i + j + half]);
+                        a[i + j + half] = sub(a[i + j], z);
+                        a[i + j] = add(a[i + j], z);
+                    }
+                }
+            }
+        }
+
+        // Zpetna transformace: dopredna, obraceni poradi a vydeleni n
+        static void inverse_transform(uint32_t* a, std::size_t n) {
+            transform(a, n);
+            std::reverse(a + 1, a + n);
+            const uint32_t inv_n = pow(static_cast<uint32_t>(n % Mod), Mod - 2);
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = mul(a[i], inv_n);
+            }
+        }
+
+        // Cyklicka konvoluce cislic modulo Mod (pro ctverec staci jedna dopredna transformace)
+        static std::vector<uint32_t> convolve(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+            std::size_t n, bool square) {
+            std::vector<uint32_t> fa(n, 0);
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                fa[i] = a[i] % Mod;
+            }
+            transform(fa.data(), n);
+
+            if (square) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    fa[i] = mul(fa[i], fa[i]);
+                }
+            }
+            else {
+                std::vector<uint32_t> fb(n, 0);
+                for (std::size_t i = 0; i < b.size(); ++i) {
+                    fb[i] = b[i] % Mod;
+                }
+                transform(fb.data(), n);
+                for (std::size_t i = 0; i < n; ++i) {
+                    fa[i] = mul(fa[i], fb[i]);
+                }
+            }
+
+            inverse_transform(fa.data(), n);
+            return fa;
+        }
+    };
+
+    using NttPrime1 = NttPrime<2013265921u, 31u>;
+    using NttPrime2 = NttPrime<1811939329u, 13u>;
+    using NttPrime3 = NttPrime<469762049u, 3u>;
+
+    // Rozlozeni limbu na 32bitove cislice
+    inline std::vector<uint32_t> ntt_digits(const limb_t* x, std::size_t size) {
+        std::vector<uint32_t> digits(size * NttDigitsPerLimb);
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t d = 0; d < NttDigitsPerLimb; ++d) {
+                digits[i * NttDigitsPerLimb + d] = static_cast<uint32_t>(static_cast<uint64_t>(x[i]) >> (32 * d));
+            }
+        }
+        return digits;
+    }
+
+    // Soucin a * b pres NTT; result musi mit misto pro an + bn limbu a an + bn <= NttMaxLimbs
+    inline void ntt_multiply(const limb_t* a, std::size_t an, const limb_t* b, std::size_t bn, limb_t* result) {
+        const bool square = a == b && an == bn;
+        const std::vector<uint32_t> da = ntt_digits(a, an);
+        const std::vector<uint32_t> db = square ? std::vector<uint32_t>() : ntt_digits(b, bn);
+        const std::size_t out_digits = (an + bn) * NttDigitsPerLimb;
+        const std::size_t n = std::bit_ceil(out_digits);
+
+        const std::vector<uint32_t> r1 = NttPrime1::convolve(da, db, n, square);
+        const std::vector<uint32_t> r2 = NttPrime2::convolve(da, db, n, square);
+        const std::vector<uint32_t> r3 = NttPrime3::convolve(da, db, n, square);
+
+        // Konstanty pro Garnerovu rekonstrukci
+        constexpr uint64_t p1 = NttPrime1::modulus;
+        constexpr uint64_t p2 = NttPrime2::modulus;
+        constexpr uint64_t p3 = NttPrime3::modulus;
+        constexpr uint64_t p12 = p1 * p2;
+        const uint32_t inv_p1_mod_p2 = NttPrime2::pow(static_cast<uint32_t>(p1 % p2), p2 - 2);
+        const uint32_t inv_p12_mod_p3 = NttPrime3::pow(static_cast<uint32_t>(p12 % p3), p3 - 2);
+
+        // Prenos mezi koeficienty jako 128bitove cislo (lo, hi)
+        uint64_t acc_lo = 0;
+        uint64_t acc_hi = 0;
+        const auto accumulate = [&](uint64_t value) {
+            acc_lo += value;
+            acc_hi += acc_lo < value;
+        };
+
+        for (std::size_t i = 0; i < out_digits; ++i) {
+            // x = t1 + t2 * p1 + t3 * p1 * p2 (jednoznacne, protoze koeficient < p1 * p2 * p3)
+            const uint32_t t1 = r1[i];
+            const uint32_t t2 = NttPrime2::mul(NttPrime2::sub(r2[i], static_cast<uint32_t>(t1 % p2)), inv_p1_mod_p2);
+            const uint32_t low_mod_p3 = static_cast<uint32_t>((t1 + static_cast<uint64_t>(t2) * p1) % p3);
+            const uint32_t t3 = NttPrime3::mul(NttPrime3::sub(r3[i], low_mod_p3), inv_p12_mod_p3);
+
+            accumulate(t1 + static_cast<uint64_t>(t2) * p1);
+            accumulate(t3 * (p12 & 0xFFFFFFFF));
+            const uint64_t high_part = t3 * (p12 >> 32);
+            accumulate(high_part << 32);
+            acc_hi += high_part >> 32;
+
+            // Vystupni 32bitova cislice a posun prenosu
+            const uint32_t digit = static_cast<uint32_t>(acc_lo);
+            acc_lo = (acc_lo >> 32) | (acc_hi << 32);
+            acc_hi >>= 32;
+
+            const std::size_t limb = i / NttDigitsPerLimb;
+            const std::size_t shift = 32 * (i % NttDigitsPerLimb);
+            if (shift == 0) {
+                result[limb] = digit;
+            }
+            else {
+                result[limb] |= static_cast<limb_t>(static_cast<uint64_t>(digit) << shift);
+            }
+        }
+    }
+}
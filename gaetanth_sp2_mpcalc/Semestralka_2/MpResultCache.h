@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "MpInt.h"
+
+// Vychozi pamet cache vysledku kalkulacky v bajtech: -DMPTERM_CACHE_BYTES=n (0 = cache vypnuta)
+#ifndef MPTERM_CACHE_BYTES
+#define MPTERM_CACHE_BYTES (64u << 20)
+#endif
+
+// Statistiky cache vysledku
+struct MpResultCacheStats final {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t extensions = 0;  // Faktorialy dopocitane z nizsiho ulozeneho k!
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+    std::size_t capacity = 0;
+};
+
+// Cache vysledku drahych podvyrazu s vytlacovanim nejdele nepouzitych polozek (LRU) a limitem pameti
+// Klicem je normalizovany zapis podvyrazu, faktorialy se ukladaji podle n a slouzi i jako vychozi body pro vetsi n
+// Vsechny metody jsou bezpecne pri soubeznem volani (vyhodnoceni vyrazu bezi v poolu vlaken)
+template <std::size_t Precision>
+class MpResultCache final {
+public:
+    using Value = MpInt<Precision>;
+
+private:
+    using limb_t = mp_detail::limb_t;
+
+    // Pridana pamet polozky nad hodnotu a klic (uzel seznamu a tabulky)
+    static constexpr std::size_t EntryOverhead = 128;
+
+    // k! se pouzije jako vychozi bod pro n!, pokud n - k <= n / FactorialExtendRatio
+    // (namereno: pro n = 10^6 se dopocet vyplati od k = 0.72 n, prime swing je pak pomalejsi)
+    static constexpr uint32_t FactorialExtendRatio = 4;
+
+    struct Entry final {
+        std::string key;
+        std::shared_ptr<const Value> value;
+        std::size_t bytes;
+        bool factorial;
+        uint32_t n;
+    };
+
+    mutable std::mutex guard;
+    std::list<Entry> entries;  // Od naposledy pouzite
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+    std::map<uint32_t, typename std::list<Entry>::iterator> factorials;
+    MpResultCacheStats stats;
+
+    // Pomocna metoda: Klic faktorialu (normalizovane klice vyrazu zacinaji cislici, zavorkou nebo jmenem)
+    static std::string factorial_key(uint32_t n) {
+        return "!" + std::to_string(n);
+    }
+
+    // Pomocna metoda: Oznaceni polozky jako naposledy pouzite (drzi se zamek)
+    void touch(typename std::list<Entry>::iterator entry) {
+        entries.splice(entries.begin(), entries, entry);
+    }
+
+    // Pomocna metoda: Vytlaceni nejstarsich polozek, dokud se nevejde extra bajtu (drzi se zamek)
+    void evict(std::size_t extra) {
+        while (!entries.empty() && stats.bytes + extra > stats.capacity) {
+            const Entry& oldest = entries.back();
+            stats.bytes -= oldest.bytes;
+            if (oldest.factorial) {
+                factorials.erase(oldest.n);
+            }
+            index.erase(oldest.key);
+            entries.pop_back();
+        }
+        stats.entries = entries.size();
+    }
+
+    // Pomocna metoda: Vlozeni hodnoty (existujici klic se jen oznaci jako pouzity)
+    void store(const std::string& key, std::shared_ptr<const Value> value, bool factorial, uint32_t n) {
+        const std::size_t bytes = value->chunks.size() * sizeof(limb_t) + key.size() + EntryOverhead;
+        std::lock_guard<std::mutex> lock(guard);
+        if (bytes > stats.capacity) {
+            return;
+        }
+        const auto found = index.find(key);
+        if (found != index.end()) {
+            touch(found->second);
+            return;
+        }
+
+        evict(bytes);
+        entries.push_front({ key, std::move(value), bytes, factorial, n });
+        index.emplace(key, entries.begin());
+        if (factorial) {
+            factorials.emplace(n, entries.begin());
+        }
+        stats.bytes += bytes;
+        stats.entries = entries.size();
+    }
+
+public:
+    explicit MpResultCache(std::size_t capacity) {
+        stats.capacity = capacity;
+    }
+
+    MpResultCache(const MpResultCache&) = delete;
+    MpResultCache& operator=(const MpResultCache&) = delete;
+
+    // Hledani vysledku podle normalizovaneho klice (nullptr pri chybeni)
+    std::shared_ptr<const Value> find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(guard);
+        const auto found = index.find(key);
+        if (found == index.end()) {
+            ++stats.misses;
+            return nullptr;
+        }
+        ++stats.hits;
+        touch(found->second);
+        return found->second->value;
+    }
+
+    // Ulozeni vysledku podvyrazu
+    void insert(const std::string& key, const Value& value) {
+        store(key, std::make_shared<const Value>(value), false, 0);
+    }
+
+    // n! z cache, pripadne dopocitany z nejblizsiho nizsiho ulozeneho k!, nebo spocitany znovu (a ulozeny)
+    Value factorial(uint32_t n) {
+        const std::string key = factorial_key(n);
+        std::shared_ptr<const Value> base;
+        uint32_t k = 0;
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            const auto found = index.find(key);
+            if (found != index.end()) {
+                ++stats.hits;
+                touch(found->second);
+                return *found->second->value;
+            }
+            ++stats.misses;
+
+            auto below = factorials.upper_bound(n);
+            if (below != factorials.begin()) {
+                --below;
+                if (n - below->first <= n / FactorialExtendRatio) {
+                    k = below->first;
+                    base = below->second->value;
+                    touch(below->second);
+                    ++stats.extensions;
+                }
+            }
+        }
+
+        auto result = std::make_shared<const Value>(base ? Value::factorial_from(*base, k, n) : Value::factorial(n));
+        store(key, result, true, n);
+        return *result;
+    }
+
+    // Zmena limitu pameti (prebytecne polozky se hned vytlaci)
+    void set_capacity(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(guard);
+        stats.capacity = capacity;
+        evict(0);
+    }
+
+    // Odstraneni vsech polozek (citace zustavaji)
+    void clear() {
+        std::lock_guard<std::mutex> lock(guard);
+        entries.clear();
+        index.clear();
+        factorials.clear();
+        stats.bytes = 0;
+        stats.entries = 0;
+    }
+
+    // Kopie statistik
+    MpResultCacheStats statistics() const {
+        std::lock_guard<std::mutex> lock(guard);
+        return stats;
+    }
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Vektorova jadra pro dlouha pole 64bitovych limbu (AVX2 / AVX-512), volba podle procesoru za behu
+// Vypnuti pri prekladu: -DMPINT_SIMD=0 (pak i na jinych prekladacich a architekturach zustava skalarni kod)
+#ifndef MPINT_SIMD
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MPINT_SIMD 1
+#else
+#define MPINT_SIMD 0
+#endif
+#endif
+
+#if MPINT_SIMD
+#include <immintrin.h>
+#endif
+
+namespace mp_detail::simd {
+
+    // r = a + b + carry pres n limbu, vraci prenos (r muze byt a nebo b)
+    using AddFunction = uint64_t(*)(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n, uint64_t carry);
+
+    // r = a posunute o shift bitu (0 < shift < 64), vraci vysunute bity (r muze byt a)
+    using ShiftFunction = uint64_t(*)(uint64_t* r, const uint64_t* a, std::size_t n, unsigned shift);
+
+    // Nejvyssi index i < n, kde se a a b lisi, nebo n pri shode
+    using ScanFunction = std::size_t(*)(const uint64_t* a, const uint64_t* b, std::size_t n);
+
+    // Tabulka jader zvolenych pro aktualni procesor (nullptr = skalarni kod v MpLimb.h)
+    struct Kernels final {
+        AddFunction add = nullptr;
+        AddFunction sub = nullptr;
+        ShiftFunction lshift = nullptr;
+        ShiftFunction rshift = nullptr;
+        ScanFunction scan = nullptr;
+    };
+
+    // Minimalni delka pole (v limbech), od ktere se vyplati vektorova jadra
+    inline constexpr std::size_t MinLimbs = 16;
+
+#if MPINT_SIMD
+    // Prenosy mezi pruhy metodou carry-lookahead: generate je maska pruhu s vlastnim prenosem,
+    // propagate maska pruhu, ktere prichozi prenos posunou dal (soucet ze samych jednicek).
+    // Pricteni (generate << 1 | carry) k propagate rozsiri prenosy pres souvisle useky propagate,
+    // xor s propagate pak necha nastavene prave pruhy, do nichz prenos vstupuje
+    inline unsigned lookahead(unsigned generate, unsigned propagate, uint64_t& carry, unsigned lanes) {
+        const unsigned chain = (generate << 1) + static_cast<unsigned>(carry) + propagate;
+        carry = chain >> lanes;
+        return (chain ^ propagate) & ((1u << lanes) - 1);
+    }
+
+    // Pomocna metoda: AVX2 maska pruhu (jeden bit na 64bitovy pruh)
+    __attribute__((target("avx2"))) inline unsigned lane_mask(__m256i v) {
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(v)));
+    }
+
+    // Pomocna metoda: AVX2 rozvinuti bitove masky na pruhy (-1 v nastavenych pruzich)
+    __attribute__((target("avx2"))) inline __m256i expand_mask(unsigned mask) {
+        const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+        return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(mask), bits), bits);
+    }
+
+    __attribute__((target("avx2"))) inline uint64_t add_avx2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n, uint64_t carry) {
+        const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        const __m256i ones = _mm256_set1_epi64x(-1);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            const __m256i sum = _mm256_add_epi64(x, y);
+            // Prenos z pruhu: sum < x bez znamenka (porovnani se znamenkem po preklopeni nejvyssiho bitu)
+            const unsigned generate = lane_mask(_mm256_cmpgt_epi64(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign)));
+            const unsigned propagate = lane_mask(_mm256_cmpeq_epi64(sum, ones));
+            const unsigned incoming = lookahead(generate, propagate, carry, 4);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_sub_epi64(sum, expand_mask(incoming)));
+        }
+        for (; i < n; ++i) {
+            const uint64_t sum = a[i] + b[i];
+            const uint64_t result = sum + carry;
+            carry = (sum < a[i]) | (result < sum);
+            r[i] = result;
+        }
+        return carry;
+    }
+
+    __attribute__((target("avx2"))) inline uint64_t sub_avx2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n, uint64_t borrow) {
+        const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            const __m256i diff = _mm256_sub_epi64(x, y);
+            // Vypujcka z pruhu: x < y, prichozi vypujcku posune dal nulovy rozdil
+            const unsigned generate = lane_mask(_mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign)));
+            const unsigned propagate = lane_mask(_mm256_cmpeq_epi64(diff, _mm256_setzero_si256()));
+            const unsigned incoming = lookahead(generate, propagate, borrow, 4);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_add_epi64(diff, expand_mask(incoming)));
+        }
+        for (; i < n; ++i) {
+            const uint64_t diff = a[i] - b[i];
+            const uint64_t result = diff - borrow;
+            borrow = (a[i] < b[i]) | (diff < borrow);
+            r[i] = result;
+        }
+        return borrow;
+    }
+
+    // Posun doleva od nejvyssich limbu (kazdy blok cte jen limby, ktere jeste nebyly prepsany)
+    __attribute__((target("avx2"))) inline uint64_t lshift_avx2(uint64_t* r, const uint64_t* a, std::size_t n, unsigned shift) {
+        const uint64_t out = a[n - 1] >> (64 - shift);
+        const __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+        const __m128i right = _mm_cvtsi32_si128(static_cast<int>(64 - shift));
+        std::size_t i = n;
+        for (; i >= 5; i -= 4) {
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 4));
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 5));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i - 4), _mm256_or_si256(_mm256_sll_epi64(high, left), _mm256_srl_epi64(low, right)));
+        }
+        for (; i > 1; --i) {
+            r[i - 1] = (a[i - 1] << shift) | (a[i - 2] >> (64 - shift));
+        }
+        r[0] = a[0] << shift;
+        return out;
+    }
+
+    // Posun doprava od nejnizsich limbu
+    __attribute__((target("avx2"))) inline uint64_t rshift_avx2(uint64_t* r, const uint64_t* a, std::size_t n, unsigned shift) {
+        const uint64_t out = a[0] << (64 - shift);
+        const __m128i right = _mm_cvtsi32_si128(static_cast<int>(shift));
+        const __m128i left = _mm_cvtsi32_si128(static_cast<int>(64 - shift));
+        std::size_t i = 0;
+        for (; i + 5 <= n; i += 4) {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), _mm256_or_si256(_mm256_srl_epi64(low, right), _mm256_sll_epi64(high, left)));
+        }
+        for (; i + 1 < n; ++i) {
+            r[i] = (a[i] >> shift) | (a[i + 1] << (64 - shift));
+        }
+        r[n - 1] = a[n - 1] >> shift;
+        return out;
+    }
+
+    __attribute__((target("avx2"))) inline std::size_t scan_avx2(const uint64_t* a, const uint64_t* b, std::size_t n) {
+        std::size_t i = n;
+        for (; i >= 4; i -= 4) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i - 4));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i - 4));
+            const unsigned equal = lane_mask(_mm256_cmpeq_epi64(x, y));
+            if (equal != 0xF) {
+                return i - 4 + (31 - static_cast<unsigned>(__builtin_clz(~equal & 0xF)));
+            }
+        }
+        while (i-- > 0) {
+            if (a[i] != b[i]) return i;
+        }
+        return n;
+    }
+
+    __attribute__((target("avx512f"))) inline uint64_t add_avx512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n, uint64_t carry) {
+        const __m512i one = _mm512_set1_epi64(1);
+        const __m512i ones = _mm512_set1_epi64(-1);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512i x = _mm512_loadu_si512(a + i);
+            const __m512i y = _mm512_loadu_si512(b + i);
+            const __m512i sum = _mm512_add_epi64(x, y);
+            const unsigned generate = _mm512_cmplt_epu64_mask(sum, x);
+            const unsigned propagate = _mm512_cmpeq_epu64_mask(sum, ones);
+            const unsigned incoming = lookahead(generate, propagate, carry, 8);
+            _mm512_storeu_si512(r + i, _mm512_mask_add_epi64(sum, static_cast<__mmask8>(incoming), sum, one));
+        }
+        return add_avx2(r + i, a + i, b + i, n - i, carry);
+    }
+
+    __attribute__((target("avx512f"))) inline uint64_t sub_avx512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n, uint64_t borrow) {
+        const __m512i one = _mm512_set1_epi64(1);
+        std::size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m512i x = _mm512_loadu_si512(a + i);
+            const __m512i y = _mm512_loadu_si512(b + i);
+            const __m512i diff = _mm512_sub_epi64(x, y);
+            const unsigned generate = _mm512_cmplt_epu64_mask(x, y);
+            const unsigned propagate = _mm512_cmpeq_epu64_mask(diff, _mm512_setzero_si512());
+            const unsigned incoming = lookahead(generate, propagate, borrow, 8);
+            _mm512_storeu_si512(r + i, _mm512_mask_sub_epi64(diff, static_cast<__mmask8>(incoming), diff, one));
+        }
+        return sub_avx2(r + i, a + i, b + i, n - i, borrow);
+    }
+
+    // Pomocna metoda: Vyber jader podle schopnosti procesoru
+    inline Kernels detect_kernels() {
+        Kernels kernels;
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            kernels.add = add_avx2;
+            kernels.sub = sub_avx2;
+            kernels.lshift = lshift_avx2;
+            kernels.rshift = rshift_avx2;
+            kernels.scan = scan_avx2;
+        }
+        if (__builtin_cpu_supports("avx512f")) {
+            kernels.add = add_avx512;
+            kernels.sub = sub_avx512;
+        }
+        return kernels;
+    }
+
+    // Jadra pro aktualni procesor (detekce probehne jednou)
+    inline const Kernels& kernels() {
+        static const Kernels selected = detect_kernels();
+        return selected;
+    }
+#else
+    inline const Kernels& kernels() {
+        static const Kernels selected;
+        return selected;
+    }
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+// Ulozeni limbu primo v objektu s pevnou kapacitou (bez alokace na halde)
+// Vsechny operace jsou constexpr, omezene MpInt lze proto pocitat i pri prekladu
+template <typename Limb, std::size_t Capacity>
+class MpFixedLimbs final {
+private:
+    std::array<Limb, Capacity> limbs{};
+    std::size_t length = 0;
+
+    // Pomocna metoda: Kontrola kapacity
+    static constexpr void ensure_capacity(std::size_t count) {
+        if (count > Capacity) {
+            throw std::length_error("Prekrocena kapacita pevneho ulozeni limbu");
+        }
+    }
+
+public:
+    using value_type = Limb;
+    using iterator = Limb*;
+    using const_iterator = const Limb*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    constexpr MpFixedLimbs() = default;
+
+    // Konstruktor s count kopiemi hodnoty
+    constexpr MpFixedLimbs(std::size_t count, Limb value) {
+        assign(count, value);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    constexpr std::size_t size() const { return length; }
+    constexpr bool empty() const { return length == 0; }
+
+    constexpr Limb* data() { return limbs.data(); }
+    constexpr const Limb* data() const { return limbs.data(); }
+
+    constexpr iterator begin() { return limbs.data(); }
+    constexpr iterator end() { return limbs.data() + length; }
+    constexpr const_iterator begin() const { return limbs.data(); }
+    constexpr const_iterator end() const { return limbs.data() + length; }
+    constexpr reverse_iterator rbegin() { return reverse_iterator(end()); }
+    constexpr reverse_iterator rend() { return reverse_iterator(begin()); }
+    constexpr const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    constexpr const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    constexpr Limb& operator[](std::size_t index) { return limbs[index]; }
+    constexpr const Limb& operator[](std::size_t index) const { return limbs[index]; }
+    constexpr Limb& back() { return limbs[length - 1]; }
+    constexpr const Limb& back() const { return limbs[length - 1]; }
+
+    constexpr void resize(std::size_t count, Limb value = Limb{}) {
+        ensure_capacity(count);
+        if (count > length) {
+            std::fill(limbs.begin() + length, limbs.begin() + count, value);
+        }
+        length = count;
+    }
+
+    constexpr void assign(std::size_t count, Limb value) {
+        ensure_capacity(count);
+        std::fill_n(limbs.begin(), count, value);
+        length = count;
+    }
+
+    constexpr void push_back(Limb value) {
+        ensure_capacity(length + 1);
+        limbs[length++] = value;
+    }
+
+    constexpr void pop_back() { --length; }
+    constexpr void clear() { length = 0; }
+
+    // Kapacita je pevna, rezervace nic nedela
+    constexpr void reserve(std::size_t) {}
+
+    constexpr bool operator==(const MpFixedLimbs& other) const {
+        return std::equal(begin(), end(), other.begin(), other.end());
+    }
+};
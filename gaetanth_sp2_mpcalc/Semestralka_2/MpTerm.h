@@ -1,6 +1,15 @@
 #pragma once
 #include "MpInt.h"
+#include "MpExpression.h"
+#include "MpResultCache.h"
+#include "MpThreadPool.h"
+#include <algorithm>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <unordered_map>
@@ -9,6 +18,7 @@
 #include <cctype>
 #include <vector>
 #include <regex>
+#include <thread>
 
 template <std::size_t Precision>
 class MPTerm final {  // Added 'final' to prevent inheritance
@@ -18,45 +28,188 @@ private:
     std::deque<MpType> history;
     static constexpr std::size_t HistorySize = 5;
 
-    // Tokenize input string to separate numbers and operators
-    std::vector<std::string> tokenizeInput(const std::string& input) const {  // Added const
-        std::vector<std::string> tokens;
-        std::string current;
+    // Results of expensive subexpressions and factorials shared by all commands of the session
+    std::unique_ptr<MpResultCache<Precision>> cache = std::make_unique<MpResultCache<Precision>>(MPTERM_CACHE_BYTES);
 
-        for (char ch : input) {
-            if (std::isdigit(ch) || ch == '$' || (ch == '-' && current.empty())) {
-                current += ch;
+    // Value of history reference $n (index 0 is $1)
+    const MpType& historyValue(std::size_t index) const {
+        if (index < history.size()) {
+            return history[index];
+        }
+        throw std::out_of_range("Invalid history index: $" + std::to_string(index + 1));
+    }
+
+    // Batch mode: lines are read in blocks, parsed and evaluated in parallel, then written in input order
+    static constexpr std::size_t BatchBlockLines = 4096;
+    static constexpr std::size_t BatchParseChunk = 64;
+
+    // Result of one batch expression, shared by the lines that reference it as $n
+    struct BatchSlot final {
+        MpType value;
+        std::string error;  // Empty on success
+    };
+
+    // One input line of a batch block
+    struct BatchLine final {
+        std::string text;
+        std::string output;                                  // Written for the line (empty = nothing)
+        bool bank = false;
+        std::optional<MpExpression<Precision>> expression;
+        std::size_t needed = 0;                              // Number of previous results the expression references
+        std::vector<std::shared_ptr<BatchSlot>> history;     // $1 .. $needed as seen by this line
+        std::shared_ptr<BatchSlot> slot;
+        bool done = false;                                   // Guarded by BatchProgress::guard
+        std::vector<std::size_t> dependents;                 // Lines waiting for this one to finish
+    };
+
+    // Evaluation state of one block, shared by its tasks (the last task may still be inside set_value when the
+    // waiting thread resumes)
+    struct BatchProgress final {
+        std::mutex guard;
+        std::size_t remaining;
+        std::promise<void> done;
+
+        explicit BatchProgress(std::size_t count) : remaining(count) {}
+    };
+
+    using BatchLines = std::vector<std::unique_ptr<BatchLine>>;
+    using BatchHistory = std::deque<std::shared_ptr<BatchSlot>>;
+
+    // Parse one batch line: comments and empty lines produce no output, parse errors are reported in place
+    static void parseBatchLine(BatchLine& line) {
+        const auto first = line.text.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line.text[first] == '#') {
+            return;
+        }
+        const std::string text = line.text.substr(first, line.text.find_last_not_of(" \t\r") - first + 1);
+        if (text == "bank") {
+            line.bank = true;
+            return;
+        }
+        try {
+            if (text.rfind("cache", 0) == 0) {
+                throw std::invalid_argument("Command not available in batch mode: " + text);
             }
-            else if (ch == '+' || ch == '-' || ch == '*' || ch == '/' || ch == '!') {
-                if (!current.empty()) {
-                    tokens.push_back(current);
-                    current.clear();
-                }
-                tokens.emplace_back(1, ch);
+            line.expression.emplace(MpExpression<Precision>::parse(text));
+            const auto& references = line.expression->history_references();
+            line.needed = references.empty() ? 0 : std::min(references.back() + 1, HistorySize);
+            line.slot = std::make_shared<BatchSlot>();
+        }
+        catch (const std::exception& e) {
+            line.output = "error: " + std::string(e.what()) + "\n";
+        }
+    }
+
+    // Start a line once its history is known. As in interactive mode, $n is the n-th previous successful result,
+    // so the previous expression lines are walked back until enough of them succeeded; an unfinished one
+    // postpones the line until it finishes (progress.guard is held)
+    void tryStartBatchLine(BatchLines& lines, std::size_t index, const BatchHistory& carried,
+                           const std::shared_ptr<BatchProgress>& progress) {
+        BatchLine& line = *lines[index];
+        std::vector<std::shared_ptr<BatchSlot>> history;
+        for (std::size_t j = index; j-- > 0 && history.size() < line.needed;) {
+            BatchLine& previous = *lines[j];
+            if (!previous.expression) continue;
+            if (!previous.done) {
+                previous.dependents.push_back(index);
+                return;
             }
-            else if (!std::isspace(ch)) {
-                throw std::invalid_argument("Invalid character in input: " + std::string(1, ch));
+            if (previous.slot->error.empty()) {
+                history.push_back(previous.slot);
             }
         }
+        for (std::size_t k = 0; k < carried.size() && history.size() < line.needed; ++k) {
+            history.push_back(carried[k]);
+        }
+        line.history = std::move(history);
 
-        if (!current.empty()) {
-            tokens.push_back(current);
+        MpThreadPool::instance().submit([this, &lines, index, &carried, progress] {
+            evaluateBatchLine(lines, index, carried, progress);
+        });
+    }
+
+    // Evaluate one batch line, then retry the lines that were waiting for it
+    void evaluateBatchLine(BatchLines& lines, std::size_t index, const BatchHistory& carried,
+                           const std::shared_ptr<BatchProgress>& progress) {
+        BatchLine& line = *lines[index];
+        try {
+            const auto resolve = [&line](std::size_t reference) -> const MpType& {
+                if (reference >= line.history.size()) {
+                    throw std::out_of_range("Invalid history index: $" + std::to_string(reference + 1));
+                }
+                return line.history[reference]->value;
+            };
+            line.slot->value = line.expression->evaluate(resolve, cache.get());
+            line.output = line.slot->value.to_string() + "\n";
+        }
+        catch (const std::exception& e) {
+            line.slot->error = e.what();
+            line.output = "error: " + line.slot->error + "\n";
         }
 
-        return tokens;
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(progress->guard);
+            line.done = true;
+            const std::vector<std::size_t> dependents = std::move(line.dependents);
+            for (const std::size_t dependent : dependents) {
+                tryStartBatchLine(lines, dependent, carried, progress);
+            }
+            last = --progress->remaining == 0;
+        }
+        if (last) {
+            progress->done.set_value();
+        }
     }
 
-    // Parse placeholder or number
-    MpType parseInput(const std::string& input) const {  // Added const
-        if (input[0] == '$') {
-            int index = input[1] - '1';
-            if (index >= 0 && index < static_cast<int>(history.size())) {
-                return history.at(index);
+    // Process one block: parallel parse, then evaluation of each line as soon as the results it references exist.
+    // carried holds the last HistorySize successful results of previous blocks and is updated for the next one
+    void runBatchBlock(BatchLines& lines, BatchHistory& carried) {
+        MpThreadPool& pool = MpThreadPool::instance();
+
+        std::vector<std::future<void>> parsing;
+        for (std::size_t begin = 0; begin < lines.size(); begin += BatchParseChunk) {
+            const std::size_t end = std::min(begin + BatchParseChunk, lines.size());
+            parsing.push_back(pool.submit([&lines, begin, end] {
+                for (std::size_t i = begin; i < end; ++i) parseBatchLine(*lines[i]);
+            }));
+        }
+        for (auto& chunk : parsing) {
+            pool.wait(chunk);
+        }
+
+        const std::size_t expressions = static_cast<std::size_t>(std::count_if(lines.begin(), lines.end(),
+            [](const std::unique_ptr<BatchLine>& line) { return line->expression.has_value(); }));
+        if (expressions > 0) {
+            const auto progress = std::make_shared<BatchProgress>(expressions);
+            std::future<void> finished = progress->done.get_future();
+            {
+                std::lock_guard<std::mutex> lock(progress->guard);
+                for (std::size_t i = 0; i < lines.size(); ++i) {
+                    if (lines[i]->expression) tryStartBatchLine(lines, i, carried, progress);
+                }
+            }
+            pool.wait(finished);
+        }
+
+        // History in input order: "bank" lists it, successful results enter it
+        for (auto& line : lines) {
+            if (line->bank) {
+                for (std::size_t i = 0; i < carried.size(); ++i) {
+                    line->output += '$';
+                    line->output += std::to_string(i + 1);
+                    line->output += ": ";
+                    line->output += carried[i]->value.to_string();
+                    line->output += '\n';
+                }
+            }
+            else if (line->expression && line->slot->error.empty()) {
+                if (carried.size() == HistorySize) {
+                    carried.pop_back();
+                }
+                carried.push_front(line->slot);
             }
-            std::cerr << "Invalid history index: " << input << std::endl;
-            throw std::out_of_range("Invalid history index");
         }
-        return MpType::from_string(input);
     }
 
     // Store result in history
@@ -67,6 +220,28 @@ private:
         history.push_front(result);
     }
 
+    // Cache commands: "cache" prints statistics, "cache clear" drops entries, "cache limit <bytes>" sets the memory cap
+    void processCacheCommand(const std::string& line) {
+        std::stringstream words(line);
+        std::string command, action, limit;
+        words >> command >> action >> limit;
+
+        if (action == "clear") {
+            cache->clear();
+        }
+        else if (action == "limit" && !limit.empty() && std::all_of(limit.begin(), limit.end(), [](unsigned char ch) { return std::isdigit(ch); })) {
+            cache->set_capacity(static_cast<std::size_t>(std::stoull(limit)));
+        }
+        else if (!action.empty()) {
+            throw std::invalid_argument("Usage: cache [clear | limit <bytes>]");
+        }
+
+        const MpResultCacheStats stats = cache->statistics();
+        std::cout << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+            << stats.extensions << " factorial extensions, " << stats.entries << " entries, "
+            << stats.bytes << " / " << stats.capacity << " bytes" << std::endl;
+    }
+
     // Print history
     void printHistory() const {  // Added const
         for (std::size_t i = 0; i < history.size(); ++i) {
@@ -91,41 +266,14 @@ public:
         }
 
         try {
-            // Handle factorial operation
-            if (line.find('!') != std::string::npos) {
-                const size_t pos = line.find('!');
-                const std::string num = line.substr(0, pos);
-                const MpType value = parseInput(num);
-
-                if (!value.fits_in_uint32()) {
-                    throw std::overflow_error("Input too large for factorial");
-                }
-
-                const uint32_t n = value.to_uint32();
-                const MpType result = MpType::factorial(n);
-                storeResult(result);
-                std::cout << "$1 = " << result.to_string() << std::endl;
+            if (line.rfind("cache", 0) == 0 && (line.size() == 5 || std::isspace(static_cast<unsigned char>(line[5])))) {
+                processCacheCommand(line);
                 return true;
             }
 
-            // Handle arithmetic operations
-            const auto tokens = tokenizeInput(line);
-            if (tokens.size() != 3) {
-                throw std::invalid_argument("Invalid input format");
-            }
-
-            MpType result = parseInput(tokens[0]);
-            for (size_t i = 1; i < tokens.size(); i += 2) {
-                const std::string& op = tokens[i];
-                const MpType rhs = parseInput(tokens[i + 1]);
-
-                if (op == "+") result = result + rhs;
-                else if (op == "-") result = result - rhs;
-                else if (op == "*") result = result * rhs;
-                else if (op == "/") result = result / rhs;
-                else throw std::invalid_argument("Invalid operator: " + op);
-            }
-
+            // Parse the whole line as an expression (operators, parentheses, function calls, $n references)
+            const MpExpression<Precision> expression = MpExpression<Precision>::parse(line);
+            const MpType result = expression.evaluate([this](std::size_t index) -> const MpType& { return historyValue(index); }, cache.get());
             storeResult(result);
             std::cout << "$1 = " << result.to_string() << std::endl;
             return true;
@@ -136,9 +284,50 @@ public:
         }
     }
 
+    // Batch mode: evaluate every line of input (up to "exit"), write one result or error line per expression in input order.
+    // $n has the interactive meaning; lines starting with '#' are comments
+    void runBatch(std::istream& input, std::ostream& output) {
+        BatchHistory carried;
+        std::size_t expressions = 0;
+        std::size_t errors = 0;
+        bool finished = false;
+
+        while (!finished) {
+            BatchLines lines;
+            std::string text;
+            while (lines.size() < BatchBlockLines && std::getline(input, text)) {
+                if (text == "exit" || text == "exit\r") {
+                    finished = true;
+                    break;
+                }
+                lines.push_back(std::make_unique<BatchLine>());
+                lines.back()->text = std::move(text);
+            }
+            if (lines.size() < BatchBlockLines) {
+                finished = true;
+            }
+            if (lines.empty()) break;
+
+            runBatchBlock(lines, carried);
+
+            // One write per block instead of a flush per result
+            std::string buffer;
+            for (const auto& line : lines) {
+                buffer += line->output;
+                expressions += line->expression ? 1 : 0;
+                errors += line->output.rfind("error: ", 0) == 0 ? 1 : 0;
+            }
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+        output.flush();
+        std::cerr << "Batch: " << expressions << " expressions evaluated, " << errors << " errors" << std::endl;
+    }
+
     // Main run loop
     void run() {
-        std::cout << "To exit type 'exit', to show history type 'bank'" << std::endl;
+        std::cout << "To exit type 'exit', to show history type 'bank', to show cache statistics type 'cache'" << std::endl;
+        std::cout << "Operators: + - * / % ^ ! ( ), history: $1 .. $" << HistorySize << std::endl;
+        std::cout << "Functions: gcd(a, b), lcm(a, b), sqrt(a), root(a, k), binom(n, k), fib(n)" << std::endl;
         std::string line;
         while (true) {
             std::cout << ">> ";
@@ -148,8 +337,8 @@ public:
     }
 };
 
-// Mode selector
-void runMode(const int mode) {  // Added const
+// Mode selector (script is the input file of batch mode, empty = standard input)
+void runMode(const int mode, const std::string& script = "") {  // Added const
     if (mode == 1) {
         std::cout << "MPCalc - unlimited precision mode" << std::endl;
         MPTerm<MpInt<0>::Unlimited> unlimited_terminal;
@@ -184,7 +373,21 @@ void runMode(const int mode) {  // Added const
             if (!demo_terminal.processCommand(cmd)) break;
         }
     }
+    else if (mode == 4) {
+        std::cout << "MPCalc - batch mode" << std::endl;
+        MPTerm<MpInt<0>::Unlimited> batch_terminal;
+        if (script.empty()) {
+            batch_terminal.runBatch(std::cin, std::cout);
+        }
+        else {
+            std::ifstream file(script);
+            if (!file) {
+                throw std::invalid_argument("Cannot open script: " + script);
+            }
+            batch_terminal.runBatch(file, std::cout);
+        }
+    }
     else {
-        std::cerr << "Invalid parameter. Use 1 (unlimited), 2 (32-byte), or 3 (demo)" << std::endl;
+        std::cerr << "Invalid parameter. Use 1 (unlimited), 2 (32-byte), 3 (demo) or 4 (batch)" << std::endl;
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Pocet vlaken sdileneho poolu pri prekladu: -DMPINT_MAX_THREADS=n (0 = podle hardware_concurrency)
+#ifndef MPINT_MAX_THREADS
+#define MPINT_MAX_THREADS 0
+#endif
+
+// Sdileny pool vlaken s kradenim prace pro paralelni vypocty v MpInt
+// Vlakno, ktere ceka na vysledek, mezitim samo zpracovava cekajici ulohy (vnorene ulohy se tak nezablokuji)
+class MpThreadPool final {
+private:
+    // Fronta uloh jednoho vlakna: vlastnik bere z konce, ostatni kradou ze zacatku
+    struct TaskQueue final {
+        std::mutex guard;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static constexpr std::size_t NoQueue = static_cast<std::size_t>(-1);
+
+    // Fronta vlakna, ktere prave bezi (NoQueue pro vlakna mimo pool)
+    static inline thread_local std::size_t current_queue = NoQueue;
+
+    // Fronty pracovnich vlaken, posledni fronta prijima ulohy z vnejsich vlaken
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleep_guard;
+    std::condition_variable wake;
+    // Pocet uloh ve frontach: zvysuje se az po vlozeni, takze kladna hodnota vzdy znamena neprazdnou frontu
+    // (uloha odebrana drive, nez se zapocitala, ho muze docasne snizit pod nulu)
+    std::atomic<std::ptrdiff_t> pending{ 0 };
+    bool stopping = false;
+
+    explicit MpThreadPool(std::size_t thread_count) {
+        const std::size_t worker_count = thread_count > 1 ? thread_count - 1 : 0;
+        for (std::size_t i = 0; i <= worker_count; ++i) {
+            queues.push_back(std::make_unique<TaskQueue>());
+        }
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    // Pomocna metoda: Vychozi pocet vlaken (volajici vlakno se pocita mezi ne)
+    static std::size_t default_thread_count() {
+        if constexpr (MPINT_MAX_THREADS > 0) {
+            return MPINT_MAX_THREADS;
+        }
+        const unsigned hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? hardware : 1;
+    }
+
+    // Pomocna metoda: Fronta, do ktere vklada aktualni vlakno
+    std::size_t home_queue() const {
+        return current_queue == NoQueue ? queues.size() - 1 : current_queue;
+    }
+
+    // Pomocna metoda: Smycka pracovniho vlakna
+    void worker_loop(std::size_t index) {
+        current_queue = index;
+        while (true) {
+            if (run_pending_task()) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_guard);
+            wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+            if (stopping) return;
+        }
+    }
+
+    // Pomocna metoda: Provedeni jedne cekajici ulohy (nejdriv z vlastni fronty, pak kradez), vraci false pri prazdnych frontach
+    bool run_pending_task() {
+        std::function<void()> task;
+        const std::size_t home = home_queue();
+        for (std::size_t i = 0; i < queues.size() && !task; ++i) {
+            TaskQueue& queue = *queues[(home + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.guard);
+            if (queue.tasks.empty()) continue;
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+
+        if (!task) return false;
+        --pending;
+        task();
+        return true;
+    }
+
+public:
+    MpThreadPool(const MpThreadPool&) = delete;
+    MpThreadPool& operator=(const MpThreadPool&) = delete;
+
+    ~MpThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_guard);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Sdilena instance (vytvori se pri prvnim pouziti)
+    static MpThreadPool& instance() {
+        static MpThreadPool pool(default_thread_count());
+        return pool;
+    }
+
+    // Pocet vlaken vcetne volajiciho
+    std::size_t thread_count() const {
+        return workers.size() + 1;
+    }
+
+    // Vlozeni ulohy do fronty aktualniho vlakna
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> submit(Function&& function) {
+        using Result = std::invoke_result_t<Function>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> future = task->get_future();
+
+        {
+            TaskQueue& queue = *queues[home_queue()];
+            std::lock_guard<std::mutex> lock(queue.guard);
+            queue.tasks.emplace_back([task] { (*task)(); });
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_guard);
+            ++pending;
+        }
+        wake.notify_one();
+        return future;
+    }
+
+    // Cekani na vysledek ulohy, behem nehoz vlakno zpracovava dalsi ulohy
+    template <typename Result>
+    Result wait(std::future<Result>& future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            // Prazdne fronty znamenaji, ze uloha uz bezi v jinem vlakne
+            if (!run_pending_task()) {
+                future.wait();
+                break;
+            }
+        }
+        return future.get();
+    }
+};
\ No newline at end of file
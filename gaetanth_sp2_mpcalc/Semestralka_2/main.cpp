@@ -9,9 +9,9 @@ int main(int argc, char** argv) {
     std::cout << "Vitejte" << std::endl;
 
     try {
-        // Overeni poctu argumentu
-        if (argc != 2) {
-            throw std::invalid_argument("Program vyzaduje presne 1 argument: 1, 2 nebo 3.");
+        // Overeni poctu argumentu (davkovy rezim 4 prijima navic soubor se skriptem)
+        if (argc != 2 && argc != 3) {
+            throw std::invalid_argument("Program vyzaduje 1 argument: 1, 2, 3 nebo 4 (4 volitelne se souborem skriptu).");
         }
 
         // Prevod argumentu na cislo
@@ -19,12 +19,15 @@ int main(int argc, char** argv) {
         std::cout << "Rezim: " << mode << std::endl;
 
         // Overeni platnosti rezimu
-        if (mode < 1 || mode > 3) {
-            throw std::invalid_argument("Neplatny rezim. Povolene hodnoty jsou 1, 2 nebo 3.");
+        if (mode < 1 || mode > 4) {
+            throw std::invalid_argument("Neplatny rezim. Povolene hodnoty jsou 1, 2, 3 nebo 4.");
+        }
+        if (argc == 3 && mode != 4) {
+            throw std::invalid_argument("Soubor skriptu lze zadat jen v davkovem rezimu 4.");
         }
 
         // Spusteni vybraneho rezimu
-        runMode(mode);
+        runMode(mode, argc == 3 ? argv[2] : "");
     }
     catch (const std::invalid_argument& e) {
         std::cerr << "Chyba v argumentech: " << e.what() << std::endl;
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "MpTerm.h"
+
+// Regresni test davkoveho rezimu s vice vlakny (preklada se s MPINT_MAX_THREADS > 1)
+// Velke mocniny se prevadi na retezec soubezne s kratkymi radky: cekani na ulohy v poolu drive
+// spoustelo cizi prevod ve vlakne, ktere drzelo zamek cache mocnin deseti, a davka uvazla
+// Cache mocnin je sdilena v celem procesu, ctest proto spousti test vicekrat, vzdy s prazdnou cache
+
+namespace {
+
+    constexpr int PowerLines = 12;
+    constexpr auto Timeout = std::chrono::seconds(120);
+
+    // Skript s prokladanymi radky 2^(400000 + i) + i a 1 + 1
+    std::string make_script() {
+        std::string script;
+        for (int i = 0; i < PowerLines; ++i) {
+            script += "2^(" + std::to_string(400000 + i) + ")+" + std::to_string(i) + "\n";
+            script += "1+1\n";
+        }
+        return script + "exit\n";
+    }
+
+    // Spusteni davky, vraci vystup
+    std::string run_batch(const std::string& script) {
+        MPTerm<MpInt<0>::Unlimited> terminal;
+        std::istringstream input(script);
+        std::ostringstream output;
+        terminal.runBatch(input, output);
+        return output.str();
+    }
+
+}
+
+int main() {
+    const std::string script = make_script();
+
+    // Uvaznuti nelze prerusit, vlakno se proto nechava bezet a test konci po limitu
+    std::packaged_task<std::string()> task([&script] { return run_batch(script); });
+    std::future<std::string> result = task.get_future();
+    std::thread(std::move(task)).detach();
+    if (result.wait_for(Timeout) != std::future_status::ready) {
+        std::cerr << "FAIL: davka neskoncila do " << Timeout.count() << " s" << std::endl;
+        std::_Exit(EXIT_FAILURE);
+    }
+
+    std::istringstream lines(result.get());
+    std::string line;
+    int count = 0;
+    int twos = 0;
+    while (std::getline(lines, line)) {
+        ++count;
+        twos += line == "2" ? 1 : 0;
+    }
+    if (count != 2 * PowerLines || twos != PowerLines) {
+        std::cerr << "FAIL: necekany vystup davky (" << count << " radku)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Davka dobehla" << std::endl;
+    return EXIT_SUCCESS;
+}
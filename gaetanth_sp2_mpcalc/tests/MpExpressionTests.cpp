@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include "MpExpression.h"
+
+namespace {
+
+    using Value = MpInt<MpInt<0>::Unlimited>;
+    using Expression = MpExpression<Value::Unlimited>;
+    using Cache = MpResultCache<Value::Unlimited>;
+
+    int failures = 0;
+
+    // Kontrola podminky s vypisem neuspechu
+    void check(bool condition, const std::string& name) {
+        if (!condition) {
+            std::cerr << "FAIL: " << name << std::endl;
+            ++failures;
+        }
+    }
+
+    // Vyhodnoceni vyrazu s historii $1 = 2^4000 + 1, $2 = 3^3000
+    Value evaluate(const std::string& input, Cache* cache) {
+        static const Value history[] = { Value::pow(Value(2), 4000) + Value(1), Value::pow(Value(3), 3000) };
+        return Expression::parse(input).evaluate([](std::size_t index) -> const Value& {
+            if (index >= std::size(history)) {
+                throw std::out_of_range("Invalid history index");
+            }
+            return history[index];
+        }, cache);
+    }
+
+    // Opakovany soucin literalu se vezme z cache (i v jinem poradi cinitelu a uvnitr vyrazu s odkazem do historie)
+    void test_cached_product() {
+        Cache cache(1u << 20);
+        const std::string a = "123456789012345678901234567890123456789";
+        const std::string b = "987654321098765432109876543210987654321";
+        const Value expected = Value::from_string(a) * Value::from_string(b);
+
+        check(evaluate(a + "*" + b, &cache) == expected, "soucin: hodnota");
+        MpResultCacheStats stats = cache.statistics();
+        check(stats.misses == 1 && stats.hits == 0 && stats.entries == 1, "soucin: ulozeni do cache");
+
+        check(evaluate(b + "*" + a, &cache) == expected, "soucin z cache: hodnota");
+        stats = cache.statistics();
+        check(stats.hits == 1 && stats.entries == 1, "soucin z cache: zasah");
+
+        check(evaluate("$1 + " + a + "*" + b, &cache) == evaluate("$1", nullptr) + expected, "soucin ve vyrazu s $1: hodnota");
+        stats = cache.statistics();
+        check(stats.hits == 2 && stats.entries == 1, "soucin ve vyrazu s $1: zasah");
+    }
+
+    // Soucin odkazu do historie se neuklada ($n je relativni, stejny zapis muze mit jinou hodnotu)
+    void test_history_product_not_cached() {
+        Cache cache(1u << 20);
+        check(evaluate("$1*$2", &cache) == evaluate("$1", nullptr) * evaluate("$2", nullptr), "soucin $1*$2: hodnota");
+        const MpResultCacheStats stats = cache.statistics();
+        check(stats.hits == 0 && stats.misses == 0 && stats.entries == 0, "soucin $1*$2: mimo cache");
+    }
+
+    // Omezeny typ scita v poradi zapisu: 3*2^254 - 3*2^254 + 2^255 + 2^254 se vejde do 256 bitu, pri scitani
+    // od nejkratsich scitancu by mezivysledek 2^254 + 3*2^254 pretekl; naopak 2^255 + 2^255 - 2^255 pretece vzdy
+    void test_bounded_sum_order() {
+        using Bounded = MpExpression<32>;
+        const auto no_history = [](std::size_t) -> const MpInt<32>& { throw std::out_of_range("Invalid history index"); };
+
+        try {
+            const MpInt<32> sum = Bounded::parse("3*2^254 - 3*2^254 + 2^255 + 2^254").evaluate(no_history);
+            check(sum.to_string() == (Value(3) * Value::pow(Value(2), 254)).to_string(), "omezeny soucet: hodnota");
+        }
+        catch (const std::exception& e) {
+            check(false, std::string("omezeny soucet: ") + e.what());
+        }
+
+        bool overflow = false;
+        try {
+            Bounded::parse("2^255 + 2^255 - 2^255").evaluate(no_history);
+        }
+        catch (const MpIntOverflowException<32>&) {
+            overflow = true;
+        }
+        check(overflow, "omezeny soucet: preteceni mezivysledku v poradi zapisu");
+    }
+
+}
+
+int main() {
+    test_cached_product();
+    test_history_product_not_cached();
+    test_bounded_sum_order();
+
+    if (failures > 0) {
+        std::cerr << failures << " kontrol selhalo" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Vsechny kontroly prosly" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,297 @@
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include "MpInt.h"
+
+namespace {
+
+    using Wide = MpInt<MpInt<0>::Unlimited>;
+
+    int failures = 0;
+    std::mt19937_64 random_engine(20240517);
+
+    // Kontrola podminky s vypisem neuspechu
+    void check(bool condition, const std::string& name) {
+        if (!condition) {
+            std::cerr << "FAIL: " << name << std::endl;
+            ++failures;
+        }
+    }
+
+    // Vyjimka preteceni vyvolana vypoctem (nullptr, pokud vypocet nepretekl)
+    template <std::size_t MaxBytes>
+    std::unique_ptr<MpIntOverflowException<MaxBytes>> overflow_of(const std::function<void()>& computation) {
+        try {
+            computation();
+        }
+        catch (const MpIntOverflowException<MaxBytes>& e) {
+            return std::make_unique<MpIntOverflowException<MaxBytes>>(e);
+        }
+        return nullptr;
+    }
+
+    // Nahodne kladne cislo s presne bits bity
+    template <class Int>
+    Int random_number(uint32_t bits) {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+        const uint32_t top_bits = (bits - 1) % 4 + 1;
+        std::string hex(1, hex_digits[(1u << (top_bits - 1)) | (random_engine() & ((1u << (top_bits - 1)) - 1))]);
+        for (uint32_t i = top_bits; i < bits; i += 4) {
+            hex.push_back(hex_digits[random_engine() & 0xF]);
+        }
+        return Int::from_hex(hex);
+    }
+
+    // Deleni po krocich s podilem kratsim nez prah Burnikel-Ziegler (kazdy krok deli Knuthovym algoritmem)
+    MpDivModResult<Wide::Unlimited> stepwise_divmod(const Wide& a, const Wide& b) {
+        constexpr uint32_t StepBits = 2048;
+        const uint32_t bits = static_cast<uint32_t>(a.to_hex().size() * 4);
+
+        MpDivModResult<Wide::Unlimited> result;
+        for (uint32_t low = (bits + StepBits - 1) / StepBits * StepBits; low > 0;) {
+            low -= StepBits;
+            const Wide piece = (a >> low) - ((a >> (low + StepBits)) << StepBits);
+            const auto step = Wide::divmod((result.remainder << StepBits) + piece, b);
+            result.quotient = (result.quotient << StepBits) + step.quotient;
+            result.remainder = step.remainder;
+        }
+        return result;
+    }
+
+    // Preteceni zjistene predem z odhadu: vysledek se nepocita, vyjimka nese odhad poctu bitu
+    void test_predicted_overflow() {
+        using Int = MpInt<32>;
+
+        const auto power = overflow_of<32>([] { Int::pow(Int(3), 1000); });
+        check(power != nullptr, "pow: preteceni");
+        check(power && power->get_predicted_bits() > 256, "pow: odhad poctu bitu");
+        check(power && power->get_overflowed_result() == Int(0), "pow: vysledek se nepocita");
+
+        const Int large = Int::pow(Int(2), 200);
+        const auto product = overflow_of<32>([&] { static_cast<void>(large * large); });
+        check(product != nullptr, "soucin: preteceni");
+        check(product && product->get_predicted_bits() >= 400, "soucin: odhad poctu bitu");
+        check(product && product->get_overflowed_result() == Int(0), "soucin: vysledek se nepocita");
+
+        const auto factorial = overflow_of<32>([] { Int::factorial(100000); });
+        check(factorial && factorial->get_predicted_bits() > 256, "faktorial: odhad poctu bitu");
+    }
+
+    // Preteceni zjistene az na vysledku: vyjimka nese preteceny vysledek a zadny odhad
+    void test_computed_overflow() {
+        using Int = MpInt<32>;
+
+        const Int half = Int::pow(Int(2), 255);
+        const auto sum = overflow_of<32>([&] { static_cast<void>(half + half); });
+        check(sum != nullptr, "soucet: preteceni");
+        check(sum && sum->get_predicted_bits() == 0, "soucet: bez odhadu");
+        check(sum && sum->get_overflowed_result().to_string() == MpInt<64>::pow(MpInt<64>(2), 256).to_string(),
+            "soucet: preteceny vysledek");
+    }
+
+    // Soucin a ctverec operandu s bits a other_bits bity proti skolnimu nasobeni (naiveMultiply)
+    template <std::size_t MaxBytes>
+    void check_large_product(uint32_t bits, uint32_t other_bits, const std::string& tier) {
+        using Int = MpInt<MaxBytes>;
+        const std::string name = tier + " " + std::to_string(bits) + "x" + std::to_string(other_bits) +
+            " bitu (MpInt<" + std::to_string(MaxBytes) + ">)";
+
+        const Int a = random_number<Int>(bits);
+        const Int b = random_number<Int>(other_bits);
+        const Int expected = a.naiveMultiply(b);
+        check(a * b == expected, name + ": soucin");
+        check(b * a == expected, name + ": soucin v opacnem poradi");
+        check(-a * b == -expected, name + ": znamenko");
+        if (bits == other_bits) {
+            check(a.square() == a.naiveMultiply(a), name + ": ctverec");
+        }
+    }
+
+    // Toom-3 (od 262144 bitu), Toom-4 (od 393216 bitu) a nevyvazeny soucin krajeny na useky
+    void test_toom_multiplication() {
+        check_large_product<Wide::Unlimited>(300000, 300000, "Toom-3");
+        check_large_product<Wide::Unlimited>(300000, 270000, "Toom-3");
+        check_large_product<Wide::Unlimited>(500000, 500000, "Toom-4");
+        check_large_product<Wide::Unlimited>(300000, 700000, "nevyvazeny");
+        check_large_product<131072>(300000, 300000, "Toom-3");
+        check_large_product<131072>(500000, 500000, "Toom-4");
+    }
+
+    // NTT (od 786432 bitu kratsiho operandu)
+    void test_ntt_multiplication() {
+        check_large_product<Wide::Unlimited>(800000, 800000, "NTT");
+        check_large_product<262144>(800000, 790000, "NTT");
+    }
+
+    // GCD Eukleidovym algoritmem se zbytky (referencni pomala cesta)
+    template <class Int>
+    Int euclid_gcd(Int a, Int b) {
+        while (b != Int(0)) {
+            Int rest = a % b;
+            a = std::move(b);
+            b = std::move(rest);
+        }
+        return a;
+    }
+
+    // GCD, LCM, rozsireny GCD a inverze nad prahem polovicniho GCD (16384 bitu) proti Eukleidovu algoritmu
+    template <std::size_t MaxBytes>
+    void check_large_gcd(uint32_t common_bits, uint32_t cofactor_bits) {
+        using Int = MpInt<MaxBytes>;
+        const std::string name = "gcd " + std::to_string(common_bits) + "+" + std::to_string(cofactor_bits) +
+            " bitu (MpInt<" + std::to_string(MaxBytes) + ">)";
+
+        const Int common = random_number<Int>(common_bits);
+        const Int a = common * random_number<Int>(cofactor_bits);
+        const Int b = common * random_number<Int>(cofactor_bits);
+        const Int expected = euclid_gcd(a, b);
+        check(Int::gcd(a, b) == expected, name + ": gcd");
+        check(Int::gcd(-a, b) == expected, name + ": gcd se zapornym operandem");
+        check(Int::lcm(a, b) == a / expected * b, name + ": lcm");
+
+        const auto extended = Int::xgcd(a, b);
+        check(extended.gcd == expected, name + ": xgcd");
+        check(Int::multiply_add(a, extended.x, b * extended.y) == expected, name + ": Bezoutova rovnost");
+
+        const Int m = b / expected;
+        const Int unit = a / expected;
+        const Int inverse = Int::invmod(unit, m);
+        check(inverse * unit % m == Int(1), name + ": invmod");
+    }
+
+    void test_large_gcd() {
+        check_large_gcd<Wide::Unlimited>(10000, 30000);
+        check_large_gcd<Wide::Unlimited>(64, 40000);
+        check_large_gcd<8192>(10000, 20000);
+    }
+
+    // Mocnina opakovanym skolnim nasobenim (referencni pomala cesta)
+    template <class Int>
+    Int naive_power(const Int& x, uint32_t p) {
+        Int result = x;
+        for (uint32_t i = 1; i < p; ++i) {
+            result = result.naiveMultiply(x);
+        }
+        return result;
+    }
+
+    // Odmocniny a test mocniny s odmocninou nad prahem testu rezidui (4096 bitu) proti mocninam ze soucinu
+    template <std::size_t MaxBytes>
+    void check_large_root(uint32_t root_bits, uint32_t p) {
+        using Int = MpInt<MaxBytes>;
+        const std::string name = "odmocnina " + std::to_string(root_bits) + " bitu, p = " + std::to_string(p) +
+            " (MpInt<" + std::to_string(MaxBytes) + ">)";
+
+        const Int odd = random_number<Int>(root_bits - 1) * Int(2) + Int(1);
+        const Int power = naive_power(odd, p);
+        check(Int::iroot(power, p) == odd, name + ": presna odmocnina");
+        check(Int::iroot(power - Int(1), p) == odd - Int(1), name + ": odmocnina p-te mocniny - 1");
+        check(Int::iroot(power + Int(1), p) == odd, name + ": odmocnina p-te mocniny + 1");
+        check(Int::is_perfect_power(power), name + ": licha mocnina");
+        check(Int::is_perfect_power(naive_power(odd * Int(2), p)), name + ": suda mocnina");
+        check(!Int::is_perfect_power(power + Int(2)), name + ": licha nemocnina");
+        check(!Int::is_perfect_power(power * Int(2)), name + ": suda nemocnina");
+        if (p == 2) {
+            check(Int::isqrt(power - Int(1)) == odd - Int(1), name + ": isqrt");
+        }
+    }
+
+    void test_large_roots() {
+        check_large_root<Wide::Unlimited>(5000, 2);
+        check_large_root<Wide::Unlimited>(5000, 3);
+        check_large_root<Wide::Unlimited>(4500, 7);
+        check_large_root<4096>(5000, 5);
+        check_large_root<4096>(6000, 3);
+    }
+
+    // Kombinacni cislo jako soucin zlomku (n - i) / (i + 1), kazdy mezivysledek je cely (referencni pomala cesta)
+    Wide product_binomial(uint32_t n, uint32_t k) {
+        Wide result(1);
+        for (uint32_t i = 0; i < k; ++i) {
+            result = result * Wide(n - i) / Wide(i + 1);
+        }
+        return result;
+    }
+
+    // Kombinacni cisla primym soucinem (k^3 <= n^2) i pres sito proti soucinu zlomku
+    template <std::size_t MaxBytes>
+    void check_binomial(uint32_t n, uint32_t k) {
+        using Int = MpInt<MaxBytes>;
+        const std::string name = "C(" + std::to_string(n) + ", " + std::to_string(k) + ") (MpInt<" +
+            std::to_string(MaxBytes) + ">)";
+
+        const std::string expected = product_binomial(n, std::min(k, n - k)).to_hex();
+        try {
+            check(Int::binomial(n, k).to_hex() == expected, name);
+        }
+        catch (const std::exception& e) {
+            check(false, name + ": " + e.what());
+        }
+    }
+
+    void test_binomials() {
+        check_binomial<Wide::Unlimited>(1000000, 1000);
+        check_binomial<Wide::Unlimited>(1000000, 999000);
+        check_binomial<Wide::Unlimited>(100000, 2154);
+        check_binomial<Wide::Unlimited>(100000, 2155);
+        check_binomial<Wide::Unlimited>(2000, 700);
+        // Citatel n^k presahuje 32768 bitu, vysledek se vejde
+        check_binomial<4096>(1000000, 2000);
+        check_binomial<4096>(3000, 1400);
+    }
+
+    // Deleni nad prahem Burnikel-Ziegler (delitel i podil nad 8192 bity) proti deleni po krocich;
+    // omezeny typ s delencem u horni meze nesmi pretect pri normalizaci ani v rekurzi
+    template <std::size_t MaxBytes>
+    void check_large_division(uint32_t dividend_bits, uint32_t divisor_bits) {
+        using Int = MpInt<MaxBytes>;
+        const std::string name = "deleni " + std::to_string(dividend_bits) + "/" + std::to_string(divisor_bits) +
+            " bitu (MpInt<" + std::to_string(MaxBytes) + ">)";
+
+        const Int a = random_number<Int>(dividend_bits);
+        const Int b = random_number<Int>(divisor_bits);
+        const auto expected = stepwise_divmod(Wide::from_hex(a.to_hex()), Wide::from_hex(b.to_hex()));
+        try {
+            const auto result = Int::divmod(a, b);
+            check(result.quotient.to_hex() == expected.quotient.to_hex(), name + ": podil");
+            check(result.remainder.to_hex() == expected.remainder.to_hex(), name + ": zbytek");
+
+            const auto negative = Int::divmod(-a, b);
+            check(negative.quotient == -result.quotient && negative.remainder == -result.remainder, name + ": znamenka");
+        }
+        catch (const std::exception& e) {
+            check(false, name + ": " + e.what());
+        }
+    }
+
+    void test_large_division() {
+        check_large_division<4096>(32768, 16001);
+        check_large_division<4096>(32768, 12000);
+        check_large_division<4096>(32700, 16384);
+        check_large_division<2048>(16384, 8193);
+        check_large_division<Wide::Unlimited>(200000, 60000);
+        check_large_division<Wide::Unlimited>(200000, 100001);
+    }
+
+}
+
+int main() {
+    test_predicted_overflow();
+    test_computed_overflow();
+    test_toom_multiplication();
+    test_ntt_multiplication();
+    test_large_division();
+    test_large_gcd();
+    test_large_roots();
+    test_binomials();
+
+    if (failures > 0) {
+        std::cerr << failures << " kontrol selhalo" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Vsechny kontroly prosly" << std::endl;
+    return EXIT_SUCCESS;
+}